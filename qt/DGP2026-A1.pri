@@ -18,6 +18,8 @@ WRL_DIR  = $$SOURCEDIR/wrl
 
 SOURCES += \
 	$$SOURCEDIR/core/Faces.cpp \
+	$$SOURCEDIR/core/MeshAnalysis.cpp \
+	$$SOURCEDIR/core/TriangleNormals.cpp \
 	$$SOURCEDIR/gui/GuiAboutDialog.cpp \
 	$$SOURCEDIR/gui/GuiGLBuffer.cpp \
 	$$SOURCEDIR/gui/GuiGLHandles.cpp \
@@ -30,15 +32,23 @@ SOURCES += \
 	$$SOURCEDIR/gui/GuiViewerData.cpp \
 	$$SOURCEDIR/io/AppLoader.cpp \
 	$$SOURCEDIR/io/AppSaver.cpp \
+	$$SOURCEDIR/io/BufferedWriter.cpp \
+	$$SOURCEDIR/io/FileMap.cpp \
+	$$SOURCEDIR/io/Loader.cpp \
+	$$SOURCEDIR/io/LoaderSgb.cpp \
 	$$SOURCEDIR/io/LoaderStl.cpp \
 	$$SOURCEDIR/io/LoaderWrl.cpp \
+	$$SOURCEDIR/io/SaverSgb.cpp \
 	$$SOURCEDIR/io/SaverStl.cpp \
 	$$SOURCEDIR/io/SaverWrl.cpp \
 	$$SOURCEDIR/io/Tokenizer.cpp \
 	$$SOURCEDIR/io/TokenizerFile.cpp \
+	$$SOURCEDIR/io/TokenizerMmap.cpp \
 	$$SOURCEDIR/io/TokenizerString.cpp \
 	$$SOURCEDIR/util/BBox.cpp \
+	$$SOURCEDIR/util/Parallel.cpp \
 	$$SOURCEDIR/util/StaticRotation.cpp \
+	$$SOURCEDIR/util/VertexWelder.cpp \
 	$$SOURCEDIR/wrl/Appearance.cpp \
 	$$SOURCEDIR/wrl/Group.cpp \
 	$$SOURCEDIR/wrl/ImageTexture.cpp \
@@ -56,7 +66,10 @@ SOURCES += \
         $$(NULL)
 
 HEADERS += \
+	$$SOURCEDIR/core/FaceIteration.hpp \
 	$$SOURCEDIR/core/Faces.hpp \
+	$$SOURCEDIR/core/MeshAnalysis.hpp \
+	$$SOURCEDIR/core/TriangleNormals.hpp \
 	$$SOURCEDIR/gui/GuiAboutDialog.hpp \
 	$$SOURCEDIR/gui/GuiGLBuffer.hpp \
 	$$SOURCEDIR/gui/GuiGLHandles.hpp \
@@ -69,18 +82,27 @@ HEADERS += \
 	$$SOURCEDIR/gui/GuiViewerData.hpp \
 	$$SOURCEDIR/io/AppLoader.hpp \
 	$$SOURCEDIR/io/AppSaver.hpp \
+	$$SOURCEDIR/io/BufferedWriter.hpp \
+	$$SOURCEDIR/io/FileMap.hpp \
 	$$SOURCEDIR/io/Loader.hpp \
+	$$SOURCEDIR/io/LoaderSgb.hpp \
 	$$SOURCEDIR/io/LoaderStl.hpp \
 	$$SOURCEDIR/io/LoaderWrl.hpp \
 	$$SOURCEDIR/io/Saver.hpp \
+	$$SOURCEDIR/io/SaverSgb.hpp \
 	$$SOURCEDIR/io/SaverStl.hpp \
 	$$SOURCEDIR/io/SaverWrl.hpp \
+	$$SOURCEDIR/io/SgbFormat.hpp \
 	$$SOURCEDIR/io/StrException.hpp \
 	$$SOURCEDIR/io/Tokenizer.hpp \
 	$$SOURCEDIR/io/TokenizerFile.hpp \
+	$$SOURCEDIR/io/TokenizerMmap.hpp \
 	$$SOURCEDIR/io/TokenizerString.hpp \
 	$$SOURCEDIR/util/BBox.hpp \
+	$$SOURCEDIR/util/Parallel.hpp \
 	$$SOURCEDIR/util/StaticRotation.hpp \
+	$$SOURCEDIR/util/UnionFind.hpp \
+	$$SOURCEDIR/util/VertexWelder.hpp \
 	$$SOURCEDIR/wrl/Appearance.hpp \
 	$$SOURCEDIR/wrl/Group.hpp \
 	$$SOURCEDIR/wrl/ImageTexture.hpp \
@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// FaceIteration.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _FACE_ITERATION_HPP_
+#define _FACE_ITERATION_HPP_
+
+#include <vector>
+
+#include "util/Parallel.hpp"
+
+using namespace std;
+
+// Header-only loops over the faces, triangles and corners of a
+// coordIndex array, as stored in an IndexedFaceSet or wrapped by the
+// Faces class. The loop bodies are passed as lambdas, and are inlined
+// by the compiler. Every negative value terminates a face, and faces
+// are numbered as in IndexedFaceSet::getNumberOfFaces(), so empty
+// faces are visited, and count; corners following the last separator
+// are visited as one more face. Each loop checks once whether the
+// array only contains triangles, and if so runs a version in which
+// the face size is a compile time constant.
+
+// returns true if coordIndex is a sequence of triangles, each one
+// followed by a separator
+template <class Index>
+inline bool isTriangleMesh(const Index* coordIndex, const Index nC) {
+  if(nC%4!=0) return false;
+  bool triangles = true;
+  for(Index iC=0;iC<nC;iC+=4)
+    triangles &=
+      (coordIndex[iC  ]>=0) & (coordIndex[iC+1]>=0) &
+      (coordIndex[iC+2]>=0) & (coordIndex[iC+3]< 0);
+  return triangles;
+}
+
+// calls f(iF,iC0,iC1) for each face iF, which owns the corners
+// iC0<=iC<iC1; iC1 is the separator, or nC for an unterminated face
+template <bool TRIANGLES, class Index, class F>
+inline void _forEachFace(const Index* coordIndex, const Index nC, F&& f) {
+  if(TRIANGLES) {
+    for(Index iF=0,iC=0;iC<nC;iF++,iC+=4)
+      f(iF,iC,iC+3);
+  } else {
+    Index iF = 0, iC0 = 0;
+    for(Index iC=0;iC<nC;iC++)
+      if(coordIndex[iC]<0) {
+        f(iF++,iC0,iC);
+        iC0 = iC+1;
+      }
+    if(iC0<nC) f(iF,iC0,nC);
+  }
+}
+
+template <class Index, class F>
+inline void forEachFace(const Index* coordIndex, const Index nC, F&& f) {
+  if(isTriangleMesh(coordIndex,nC))
+    _forEachFace<true,Index>(coordIndex,nC,f);
+  else
+    _forEachFace<false,Index>(coordIndex,nC,f);
+}
+
+// calls f(iF,iC0,iC1,iC2) for each triangle of the fan triangulation
+// of face iF, where iC0 is the first corner of the face; faces with
+// fewer than 3 corners are skipped
+template <class Index, class F>
+inline void forEachTriangle(const Index* coordIndex, const Index nC, F&& f) {
+  auto fan = [&f](Index iF, Index iC0, Index iC1) {
+    for(Index iC=iC0+2;iC<iC1;iC++)
+      f(iF,iC0,iC-1,iC);
+  };
+  if(isTriangleMesh(coordIndex,nC))
+    _forEachFace<true,Index>(coordIndex,nC,fan);
+  else
+    _forEachFace<false,Index>(coordIndex,nC,fan);
+}
+
+// calls f(iF,iCp,iC,iCn) for each corner iC of face iF, where iCp and
+// iCn are the previous and next corners in the cyclical order of the
+// face
+template <class Index, class F>
+inline void forEachCorner(const Index* coordIndex, const Index nC, F&& f) {
+  auto cycle = [&f](Index iF, Index iC0, Index iC1) {
+    for(Index iCp=iC1-1,iC=iC0;iC<iC1;iCp=iC++)
+      f(iF,iCp,iC,(iC+1<iC1)?iC+1:iC0);
+  };
+  if(isTriangleMesh(coordIndex,nC))
+    _forEachFace<true,Index>(coordIndex,nC,cycle);
+  else
+    _forEachFace<false,Index>(coordIndex,nC,cycle);
+}
+
+// the same loops over vectors
+
+template <class Index, class F>
+inline void forEachFace(const vector<Index>& coordIndex, F&& f) {
+  forEachFace(coordIndex.data(),(Index)coordIndex.size(),f);
+}
+
+template <class Index, class F>
+inline void forEachTriangle(const vector<Index>& coordIndex, F&& f) {
+  forEachTriangle(coordIndex.data(),(Index)coordIndex.size(),f);
+}
+
+template <class Index, class F>
+inline void forEachCorner(const vector<Index>& coordIndex, F&& f) {
+  forEachCorner(coordIndex.data(),(Index)coordIndex.size(),f);
+}
+
+// Splits a coordIndex array into the blocks of Parallel::forRange(),
+// moved to face boundaries, so that the faces can be visited in parallel, with the
+// same face numbers as in the serial loops; arrays with fewer than
+// 2^20 entries are not split. Each chunk is checked separately for
+// triangles. The constructor makes one parallel pass over the array,
+// to count the faces of each chunk.
+
+template <class Index>
+class FaceChunks {
+
+public:
+
+  FaceChunks(const Index* coordIndex, const Index nC):
+    _coordIndex(coordIndex) {
+    size_t grain   = Parallel::getGrain((size_t)nC,0,1u<<20);
+    size_t nChunks = Parallel::split((size_t)nC,grain,_cut);
+    _firstFace.resize(nChunks+1,0);
+    _triangles.resize(nChunks);
+    // chunk i starts right after the first separator found at or
+    // after its nominal start
+    for(size_t i=1;i<nChunks;i++) {
+      Index iC = _cut[i];
+      while(iC<nC && coordIndex[iC-1]>=0) iC++;
+      _cut[i] = iC;
+    }
+    Parallel::forEach(nChunks,[&](size_t i) {
+      const Index* c = coordIndex+_cut[i];
+      const Index  n = _cut[i+1]-_cut[i];
+      _triangles[i] = isTriangleMesh(c,n);
+      Index nF = 0;
+      if(_triangles[i]) {
+        nF = n/4;
+      } else {
+        for(Index iC=0;iC<n;iC++)
+          if(c[iC]<0) nF++;
+        // corners following the last separator form one more face
+        if(n>0 && c[n-1]>=0) nF++;
+      }
+      _firstFace[i+1] = nF;
+    });
+    for(size_t i=0;i<nChunks;i++)
+      _firstFace[i+1] += _firstFace[i];
+  }
+
+  Index getNumberOfFaces() const {
+    return _firstFace.back();
+  }
+
+  // calls f(iF0,iC0,iC1,triangles) for each chunk, from several
+  // threads at once; the chunk owns the corners iC0<=iC<iC1, and its
+  // first face is iF0; triangles is true if the chunk contains only
+  // triangles
+  template <class F>
+  void forEachChunk(F&& f) const {
+    Parallel::forEach(_triangles.size(),[&](size_t i) {
+      f(_firstFace[i],_cut[i],_cut[i+1],_triangles[i]!=0);
+    });
+  }
+
+  // calls f(iF,iC0,iC1) for each face iF, as forEachFace() does, but
+  // from several threads at once; f must only write data owned by
+  // face iF
+  template <class F>
+  void forEachFace(F&& f) const {
+    forEachChunk([&](Index iF0, Index iC0, Index iC1, bool triangles) {
+      auto shift = [&f,iF0,iC0](Index iF, Index i0, Index i1) {
+        f(iF0+iF,iC0+i0,iC0+i1);
+      };
+      if(triangles)
+        _forEachFace<true,Index>(_coordIndex+iC0,iC1-iC0,shift);
+      else
+        _forEachFace<false,Index>(_coordIndex+iC0,iC1-iC0,shift);
+    });
+  }
+
+private:
+
+  const Index*  _coordIndex;
+  vector<Index> _cut;
+  vector<Index> _firstFace;
+  vector<char>  _triangles;
+
+};
+
+#endif /* _FACE_ITERATION_HPP_ */
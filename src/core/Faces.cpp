@@ -35,117 +35,525 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <math.h>
+#include <algorithm>
+#include <atomic>
 #include "Faces.hpp"
+#include "util/Parallel.hpp"
   
-Faces::Faces(const int nV, const vector<int>& coordIndex) {
-    // define variance
-    _coordIndex = coordIndex;
-    _nV = nV;
-    _nF = 0;
-
-    //scan all the data and calculate the number of faces
-    int maxVertexIndex = -1;
-    int currentFaceStart = 0;
-    bool isNewFace = true;
-
-    for (int i = 0; i < _coordIndex.size(); ++i){
-        int val = _coordIndex[i];
-        if (val == -1){
-            _cornerFace.push_back(-1);
-        }else{
-            _cornerFace.push_back(_nF);
-            if (val > maxVertexIndex) maxVertexIndex = val;
-        }
+// coordIndex arrays with fewer corners are scanned on the calling
+// thread
+static const int _parallelThreshold = 1<<20;
 
-        //test faces
-        if (isNewFace) {
-            if (val != -1){
-                _faceFirstCorner.push_back(i);
-                _nF++;
-                isNewFace = false;
-            }
-        }
+// values stored in _cornerTwin for corners without a twin; the
+// separators are marked as boundary edges
+static const int _BOUNDARY     = -1;
+static const int _NON_MANIFOLD = -2;
 
-        //if meet -1, means current face is finished and the next one is new face
-        if (val == -1) {
-            isNewFace= true;
-        }
+// face starts and empty faces are recognized by looking at the
+// previous corner only, so any range of corners can be scanned
+// independently of the others
+
+template <class Index>
+static bool _isFaceStart(const Index* coordIndex, const Index iC) {
+  return coordIndex[iC]!=-1 && (iC==0 || coordIndex[iC-1]==-1);
+}
+
+template <class Index>
+static bool _isEmptyFace(const Index* coordIndex, const Index iC) {
+  return coordIndex[iC]==-1 && (iC==0 || coordIndex[iC-1]==-1);
+}
+
+template <class Index>
+FacesT<Index>::FacesT(const Index nV, const vector<Index>& coordIndex):
+  _nV(nV),
+  _nF(0),
+  _packed(true),
+  _nC((Index)coordIndex.size()),
+  _coord((const Index*)0),
+  _coordIndex(coordIndex) {
+  _coord = _coordIndex.data();
+  _build();
+}
+
+template <class Index>
+FacesT<Index>::FacesT(const Index nV, vector<Index>&& coordIndex):
+  _nV(nV),
+  _nF(0),
+  _packed(true),
+  _nC((Index)coordIndex.size()),
+  _coord((const Index*)0),
+  _coordIndex(std::move(coordIndex)) {
+  _coord = _coordIndex.data();
+  _build();
+}
 
+template <class Index>
+FacesT<Index>::FacesT(const Index nV, const Index nC, const Index* coordIndex):
+  _nV(nV),
+  _nF(0),
+  _packed(true),
+  _nC((nC>0)?nC:0),
+  _coord(coordIndex),
+  _coordIndex() {
+  _build();
+}
+
+template <class Index>
+void FacesT<Index>::_build() {
+  const Index  nC         = _nC;
+  const Index* coordIndex = _coord;
+  _cornerFace.resize(nC);
+  Index maxVertexIndex = -1;
+  Index iF = -1; // face being scanned, or -1 between faces
+
+  size_t nThreads = Parallel::getNumberOfThreads();
+  if(nThreads<=1 || nC<_parallelThreshold) {
+
+    // single pass over coordIndex; the offsets are reserved for a
+    // triangle mesh, which is exact for triangles and too large for
+    // any mesh with larger faces
+    _faceFirstCorner.reserve(nC/4+2);
+    for(Index iC=0;iC<nC;iC++) {
+      const Index iV = coordIndex[iC];
+      if(iV==-1) {
+        // a separator which does not close a face is an empty face
+        if(iF<0) _packed = false;
+        iF = -1;
+      } else {
+        if(iF<0) {
+          iF = _nF++;
+          _faceFirstCorner.push_back(iC);
+        }
+        if(iV>maxVertexIndex) maxVertexIndex = iV;
+      }
+      _cornerFace[iC] = iF;
     }
 
-//check the number of vertices
-    if (maxVertexIndex >= _nV) {
-        _nV= maxVertexIndex + 1;
+  } else {
+
+    // split the corners into the blocks of Parallel::forRange();
+    // count the faces starting in each chunk, and the maximum vertex
+    // index
+    vector<Index> cut;
+    size_t nChunks = Parallel::split((size_t)nC,Parallel::getGrain((size_t)nC,0),cut);
+    vector<Index>  chunkFaces(nChunks+1,0);
+    vector<Index>  chunkMax(nChunks,-1);
+    vector<char> chunkPacked(nChunks,1);
+    Parallel::forEach(nChunks,[&](size_t i) {
+      Index nF = 0, maxV = -1;
+      char packed = 1;
+      for(Index iC=cut[i];iC<cut[i+1];iC++) {
+        if(_isFaceStart(coordIndex,iC)) nF++;
+        if(_isEmptyFace(coordIndex,iC)) packed = 0;
+        if(coordIndex[iC]>maxV) maxV = coordIndex[iC];
+      }
+      chunkFaces[i+1] = nF;
+      chunkMax[i]     = maxV;
+      chunkPacked[i]  = packed;
+    });
+
+    // prefix sum of the face counts, and reductions
+    for(size_t i=0;i<nChunks;i++) {
+      chunkFaces[i+1] += chunkFaces[i];
+      if(chunkMax[i]>maxVertexIndex) maxVertexIndex = chunkMax[i];
+      if(chunkPacked[i]==0) _packed = false;
     }
+    _nF = chunkFaces[nChunks];
+    _faceFirstCorner.reserve(_nF+1);
+    _faceFirstCorner.resize(_nF);
+
+    // each chunk starts within the face which precedes its first
+    // face start, unless it starts on a separator or a face start
+    Parallel::forEach(nChunks,[&](size_t i) {
+      Index nF = chunkFaces[i];
+      Index iF = nF-1;
+      for(Index iC=cut[i];iC<cut[i+1];iC++) {
+        if(coordIndex[iC]==-1) {
+          iF = -1;
+        } else if(_isFaceStart(coordIndex,iC)) {
+          iF = nF++;
+          _faceFirstCorner[iF] = iC;
+        }
+        _cornerFace[iC] = iF;
+      }
+    });
+    if(nC>0) iF = _cornerFace[nC-1];
+  }
 
+  // if the last face is not terminated, assume a separator at nC
+  _faceFirstCorner.push_back((iF<0)?nC:nC+1);
+
+  if(maxVertexIndex>=_nV) _nV = maxVertexIndex+1;
+}
+
+template <class Index>
+Index FacesT<Index>::_faceEnd(const Index iF) const {
+  if(_packed) return _faceFirstCorner[iF+1]-1;
+  // empty faces leave extra separators between consecutive faces
+  Index iC = _faceFirstCorner[iF];
+  while(iC<_nC && _coord[iC]!=-1) iC++;
+  return iC;
 }
 
-int Faces::getNumberOfVertices() const {
-  // TODO
+template <class Index>
+Index FacesT<Index>::getNumberOfVertices() const {
   return _nV;
 }
 
-int Faces::getNumberOfFaces() const {
-  // TODO
+template <class Index>
+Index FacesT<Index>::getNumberOfFaces() const {
   return _nF;
 }
 
-int Faces::getNumberOfCorners() const {
-  // TODO
-    return (int)_coordIndex.size();
+template <class Index>
+Index FacesT<Index>::getNumberOfCorners() const {
+  return _nC;
 }
 
-int Faces::getFaceSize(const int iF) const {
-  // if step out then return to 0
-  if ( iF <0 || iF >= _nF ) return 0;
-
-  int start = _faceFirstCorner[iF];
-  int count = 0;
+template <class Index>
+bool FacesT<Index>::isPacked() const {
+  return _packed;
+}
 
-  //count from the start untill -1
-  for (int i= start; i< _coordIndex.size(); ++i){
-      if (_coordIndex[i]== -1) break;
-      count++;
-  }
-  return count;
+template <class Index>
+Index FacesT<Index>::getFaceSize(const Index iF) const {
+  if((size_t)iF>=(size_t)_nF) return 0;
+  return _faceEnd(iF)-_faceFirstCorner[iF];
 }
 
-int Faces::getFaceFirstCorner(const int iF) const {
-  // TODO
-  if (iF < 0 || iF >= _nF) return -1;
+template <class Index>
+Index FacesT<Index>::getFaceFirstCorner(const Index iF) const {
+  if((size_t)iF>=(size_t)_nF) return -1;
   return _faceFirstCorner[iF];
 }
 
-int Faces::getFaceVertex(const int iF, const int j) const {
-  // TODO
-  if (iF < 0 || iF >= _nF) return -1;
+template <class Index>
+Index FacesT<Index>::getFaceVertex(const Index iF, const Index j) const {
+  if((size_t)j>=(size_t)getFaceSize(iF)) return -1;
+  return _coord[_faceFirstCorner[iF]+j];
+}
+
+template <class Index>
+Index FacesT<Index>::getCornerFace(const Index iC) const {
+  if((size_t)iC>=(size_t)_cornerFace.size()) return -1;
+  return _cornerFace[iC];
+}
+
+template <class Index>
+Index FacesT<Index>::getCornerVertex(const Index iC) const {
+  if((size_t)iC>=(size_t)_nC) return -1;
+  return _coord[iC];
+}
 
-  int start = _faceFirstCorner[iF];
-  int index = start +j;
-  if (index >= _coordIndex.size() || _coordIndex[index] == -1) return -1;
-  return _coordIndex[index];
+template <class Index>
+Index FacesT<Index>::getNextCorner(const Index iC) const {
+  const Index nC = _nC;
+  if((size_t)iC>=(size_t)nC || _coord[iC]==-1) return -1;
+  // the corner after iC is either in the same face or a separator
+  const Index iN = iC+1;
+  return (iN<nC && _coord[iN]!=-1)?iN:_faceFirstCorner[_cornerFace[iC]];
+}
 
+template <class Index>
+bool FacesT<Index>::_cornerEdge(const Index iC, Index& vMin, Index& vMax) const {
+  // same as getNextCorner(), without the range checks
+  const Index iV = _coord[iC];
+  if(iV==-1) return false;
+  const Index iN = iC+1;
+  Index jV = (iN<_nC)?_coord[iN]:-1;
+  if(jV==-1) jV = _coord[_faceFirstCorner[_cornerFace[iC]]];
+  vMin = (iV<jV)?iV:jV;
+  vMax = (iV<jV)?jV:iV;
+  return vMin>=0;
+}
 
+// Splits the corners into the blocks of Parallel::forRange(), or into
+// a single block if the array is small.
+
+template <class Index>
+static size_t _splitCorners(const Index nC, vector<Index>& cut) {
+  size_t grain = Parallel::getGrain((size_t)nC,0,(size_t)_parallelThreshold);
+  return Parallel::split((size_t)nC,grain,cut);
 }
 
-int Faces::getCornerFace(const int iC) const {
-  // TODO
-    if (iC < 0 || iC >= _cornerFace.size()) return -1;
-    return _cornerFace[iC];
+// Counting sort of the corners on an integer key in the range
+// [0,nKeys), or -1 for the corners to be skipped; key(iC,value)
+// returns the key of corner iC, and may also set a value to be stored
+// along with it. On return the corners with key k, and their values if
+// requested, are stored in item[first[k]] through item[first[k+1]-1],
+// in no particular order. With more than one chunk the counts are
+// updated atomically.
+
+template <class Index, class Key>
+static void _groupCorners
+(const vector<Index>& cut, const Index nKeys, Key key,
+ vector<Index>& first, vector<Index>& item, vector<Index>* value) {
+  const size_t nChunks = cut.size()-1;
+  auto group = [&](auto& position) {
+    Parallel::forEach(nChunks,[&](size_t i) {
+      Index v = -1;
+      for(Index iC=cut[i];iC<cut[i+1];iC++) {
+        const Index k = key(iC,v);
+        if(k>=0) position[k+1]++;
+      }
+    });
+    first.assign(nKeys+1,0);
+    for(Index k=0;k<nKeys;k++) {
+      first[k+1]  = first[k]+position[k+1];
+      position[k] = first[k];
     }
+    item.resize(first[nKeys]);
+    if(value!=(vector<Index>*)0) value->resize(first[nKeys]);
+    Parallel::forEach(nChunks,[&](size_t i) {
+      Index v = -1;
+      for(Index iC=cut[i];iC<cut[i+1];iC++) {
+        const Index k = key(iC,v);
+        if(k<0) continue;
+        const Index j = position[k]++;
+        item[j] = iC;
+        if(value!=(vector<Index>*)0) (*value)[j] = v;
+      }
+    });
+  };
+  if(nChunks>1) {
+    vector<atomic<Index> > position(nKeys+1);
+    group(position);
+  } else {
+    vector<Index> position(nKeys+1,0);
+    group(position);
+  }
+}
+
+// sorts the n corners of a group on the larger vertex index of their
+// edges, and on the corner index; groups are usually small, except
+// for the vertices of very high valence
 
-int Faces::getNextCorner(const int iC) const {
-        if (iC < 0 || iC >= _coordIndex.size()) return -1;
-        if (_coordIndex[iC] == -1) return -1;
-        if (iC + 1 < _coordIndex.size() && _coordIndex[iC + 1] == -1) {
-            int currentFace = _cornerFace[iC];
-            return _faceFirstCorner[currentFace];
-        }else {
-            return iC + 1;
+template <class Index>
+static void _sortGroup(Index* corner, Index* far, const Index n) {
+  if(n<=32) {
+    for(Index j=1;j<n;j++) {
+      const Index iC = corner[j], vF = far[j];
+      Index k = j;
+      for(;k>0 && (far[k-1]>vF || (far[k-1]==vF && corner[k-1]>iC));k--) {
+        corner[k] = corner[k-1];
+        far[k]    = far[k-1];
+      }
+      corner[k] = iC;
+      far[k]    = vF;
+    }
+  } else {
+    vector<pair<Index,Index> > group(n);
+    for(Index j=0;j<n;j++)
+      group[j] = make_pair(far[j],corner[j]);
+    sort(group.begin(),group.end());
+    for(Index j=0;j<n;j++) {
+      far[j]    = group[j].first;
+      corner[j] = group[j].second;
+    }
+  }
+}
+
+// The corners are grouped on the smaller vertex index of their edges,
+// by a counting sort, which also stores the larger vertex
+// index of each corner in the far array. Each group is then sorted on
+// the larger vertex index, and on the corner index, so that the
+// corners sharing an edge become adjacent, and the result does not
+// depend on the number of threads. Returns the number of chunks used
+// to split the work.
+
+template <class Index>
+size_t FacesT<Index>::_sortEdgeCorners
+(vector<Index>& first, vector<Index>& corner, vector<Index>& far) const {
+  const Index nV = _nV;
+  vector<Index> cut;
+  size_t nChunks = _splitCorners(_nC,cut);
+  _groupCorners(cut,nV,[this](Index iC, Index& vMax) {
+    Index vMin;
+    return _cornerEdge(iC,vMin,vMax)?vMin:-1;
+  },first,corner,&far);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    const Index v0 = (Index)(((size_t)nV*i)/nChunks);
+    const Index v1 = (Index)(((size_t)nV*(i+1))/nChunks);
+    for(Index iV=v0;iV<v1;iV++)
+      _sortGroup(corner.data()+first[iV],far.data()+first[iV],
+                 first[iV+1]-first[iV]);
+  });
+  return nChunks;
+}
+
+// returns the end of the run of corners which share the edge of
+// corner[k], within the group which ends at kEnd
+template <class Index>
+static Index _edgeRunEnd(const vector<Index>& far, Index k, const Index kEnd) {
+  const Index vMax = far[k];
+  for(k++;k<kEnd && far[k]==vMax;k++);
+  return k;
+}
+
+template <class Index>
+void FacesT<Index>::buildTwinCorners() {
+  const Index nV = _nV;
+  _cornerTwin.assign(_nC,_BOUNDARY);
+  vector<Index> first,corner,far;
+  size_t nChunks = _sortEdgeCorners(first,corner,far);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    const Index v0 = (Index)(((size_t)nV*i)/nChunks);
+    const Index v1 = (Index)(((size_t)nV*(i+1))/nChunks);
+    for(Index iV=v0;iV<v1;iV++) {
+      for(Index j=first[iV],k;j<first[iV+1];j=k) {
+        k = _edgeRunEnd(far,j,first[iV+1]);
+        if(k-j==2) {
+          _cornerTwin[corner[j]]   = corner[j+1];
+          _cornerTwin[corner[j+1]] = corner[j];
+        } else if(k-j>2) {
+          while(j<k) _cornerTwin[corner[j++]] = _NON_MANIFOLD;
         }
+      }
+    }
+  });
+}
+
+template <class Index>
+bool FacesT<Index>::hasTwinCorners() const {
+  return (Index)_cornerTwin.size()==_nC && _nC>0;
+}
+
+template <class Index>
+Index FacesT<Index>::getTwinCorner(const Index iC) const {
+  if((size_t)iC>=(size_t)_cornerTwin.size()) return -1;
+  const Index iT = _cornerTwin[iC];
+  return (iT>=0)?iT:-1;
+}
+
+template <class Index>
+bool FacesT<Index>::isBoundaryEdge(const Index iC) const {
+  if((size_t)iC>=(size_t)_cornerTwin.size()) return false;
+  return _cornerTwin[iC]==_BOUNDARY && _coord[iC]!=-1;
+}
+
+template <class Index>
+bool FacesT<Index>::isNonManifoldEdge(const Index iC) const {
+  if((size_t)iC>=(size_t)_cornerTwin.size()) return false;
+  return _cornerTwin[iC]==_NON_MANIFOLD;
+}
+
+// The corners are grouped on their vertex indices, and each group is
+// sorted, so that the result does not depend on the number of threads.
+
+template <class Index>
+void FacesT<Index>::buildVertexCorners() {
+  const Index nV = _nV;
+  vector<Index> cut;
+  size_t nChunks = _splitCorners(_nC,cut);
+  const Index* coord = _coord;
+  _groupCorners(cut,nV,[coord](Index iC, Index&) {
+    return (coord[iC]>=0)?coord[iC]:-1;
+  },_vertexFirstCorner,_vertexCorner,(vector<Index>*)0);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    const Index v0 = (Index)(((size_t)nV*i)/nChunks);
+    const Index v1 = (Index)(((size_t)nV*(i+1))/nChunks);
+    for(Index iV=v0;iV<v1;iV++)
+      sort(_vertexCorner.begin()+_vertexFirstCorner[iV],
+           _vertexCorner.begin()+_vertexFirstCorner[iV+1]);
+  });
+}
+
+template <class Index>
+bool FacesT<Index>::hasVertexCorners() const {
+  return (Index)_vertexFirstCorner.size()==_nV+1;
+}
+
+template <class Index>
+Index FacesT<Index>::getVertexSize(const Index iV) const {
+  if(hasVertexCorners()==false || (size_t)iV>=(size_t)_nV) return 0;
+  return _vertexFirstCorner[iV+1]-_vertexFirstCorner[iV];
+}
+
+template <class Index>
+Index FacesT<Index>::getVertexCorner(const Index iV, const Index j) const {
+  if((size_t)j>=(size_t)getVertexSize(iV)) return -1;
+  return _vertexCorner[_vertexFirstCorner[iV]+j];
+}
+
+template <class Index>
+Index FacesT<Index>::getVertexFace(const Index iV, const Index j) const {
+  const Index iC = getVertexCorner(iV,j);
+  return (iC<0)?-1:_cornerFace[iC];
+}
+
+// The edges are numbered in the order of the sorted edge corners, so
+// each chunk of vertices first counts the edges which start in it.
 
+template <class Index>
+void FacesT<Index>::buildEdges() {
+  const Index nV = _nV;
+  vector<Index> first,far;
+  _edgeCorner.clear();
+  size_t nChunks = _sortEdgeCorners(first,_edgeCorner,far);
+  vector<Index> chunkEdges(nChunks+1,0);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    const Index v0 = (Index)(((size_t)nV*i)/nChunks);
+    const Index v1 = (Index)(((size_t)nV*(i+1))/nChunks);
+    Index nE = 0;
+    for(Index iV=v0;iV<v1;iV++)
+      for(Index j=first[iV];j<first[iV+1];j=_edgeRunEnd(far,j,first[iV+1]))
+        nE++;
+    chunkEdges[i+1] = nE;
+  });
+  for(size_t i=0;i<nChunks;i++)
+    chunkEdges[i+1] += chunkEdges[i];
+  const Index nE = chunkEdges[nChunks];
+  _edgeVertex.resize(2*nE);
+  _edgeFirstCorner.resize(nE+1);
+  _edgeFirstCorner[nE] = (Index)_edgeCorner.size();
+  Parallel::forEach(nChunks,[&](size_t i) {
+    const Index v0 = (Index)(((size_t)nV*i)/nChunks);
+    const Index v1 = (Index)(((size_t)nV*(i+1))/nChunks);
+    Index iE = chunkEdges[i];
+    for(Index iV=v0;iV<v1;iV++) {
+      for(Index j=first[iV];j<first[iV+1];j=_edgeRunEnd(far,j,first[iV+1])) {
+        _edgeVertex[2*iE  ] = iV;
+        _edgeVertex[2*iE+1] = far[j];
+        _edgeFirstCorner[iE++] = j;
+      }
+    }
+  });
+}
+
+template <class Index>
+bool FacesT<Index>::hasEdges() const {
+  return _edgeFirstCorner.size()>0;
+}
+
+template <class Index>
+Index FacesT<Index>::getNumberOfEdges() const {
+  return (Index)(_edgeVertex.size()/2);
 }
 
+template <class Index>
+Index FacesT<Index>::getEdgeVertex(const Index iE, const Index j) const {
+  if((size_t)iE>=(size_t)getNumberOfEdges() || (size_t)j>1) return -1;
+  return _edgeVertex[2*iE+j];
+}
 
+template <class Index>
+Index FacesT<Index>::getEdgeSize(const Index iE) const {
+  if((size_t)iE>=(size_t)getNumberOfEdges()) return 0;
+  return _edgeFirstCorner[iE+1]-_edgeFirstCorner[iE];
+}
 
+template <class Index>
+Index FacesT<Index>::getEdgeCorner(const Index iE, const Index j) const {
+  if((size_t)j>=(size_t)getEdgeSize(iE)) return -1;
+  return _edgeCorner[_edgeFirstCorner[iE]+j];
+}
+
+template <class Index>
+Index FacesT<Index>::getEdgeFace(const Index iE, const Index j) const {
+  const Index iC = getEdgeCorner(iE,j);
+  return (iC<0)?-1:_cornerFace[iC];
+}
 
+// the index types supported by the Faces class
+template class FacesT<int32_t>;
+template class FacesT<int64_t>;
@@ -37,66 +37,198 @@
 #ifndef _FACES_HPP_
 #define _FACES_HPP_
 
+#include <stddef.h>
+#include <stdint.h>
 #include <vector>
 
 using namespace std;
 
-class Faces {
+// The index type, used for vertex, face, corner and edge indices, is a
+// template parameter. The 32 bit version, which uses half the memory,
+// is the default; the 64 bit version is needed when the number of
+// corners, or of vertices, does not fit in 32 bits. Both are
+// instantiated in Faces.cpp.
+
+template <class Index>
+class FacesT {
   
 public:
-          Faces(const int nV, const vector<int>& coordIndex);
+
+  // The coordIndex array can be copied, moved, or borrowed. The
+  // first constructor copies it. The second one takes ownership of
+  // its storage, and leaves the argument empty. The third one only
+  // keeps the pointer, so the nC entries must not be modified or
+  // freed while the instance is in use; this avoids duplicating the
+  // largest array of the mesh when Faces is only used to traverse
+  // it.
+          FacesT(const Index nV, const vector<Index>& coordIndex);
+          FacesT(const Index nV, vector<Index>&& coordIndex);
+          FacesT(const Index nV, const Index nC, const Index* coordIndex);
+
+  // a copy would borrow from the original; use std::move instead
+          FacesT(const FacesT& faces) = delete;
+  FacesT& operator=(const FacesT& faces) = delete;
+          FacesT(FacesT&& faces) = default;
+  FacesT& operator=(FacesT&& faces) = default;
 
   // The constructor should compare the nV value passed as a parameter
   // with the non-negative values in stored in the coordIndex index
   // array, and update the value of nV stored internally if
   // necessary. This value returns the updated value;
-  int     getNumberOfVertices()                    const;
+  Index   getNumberOfVertices()                    const;
 
   // The faces are conted in the constructor by counting the number of
   // -1's in the coordIndex array. If coordIndex is not empty, the
   // last value of coordIndex should be -1.
-  int     getNumberOfFaces()                       const;
+  Index   getNumberOfFaces()                       const;
 
   // The number of corners is defined as the size of the coordIndex
   // array.  Including the -1 face separators as corners simplify many
   // of the algorithms.
-  int     getNumberOfCorners()                     const;
+  Index   getNumberOfCorners()                     const;
+
+  // Returns true if the coordIndex array has no leading or repeated
+  // -1 separators. Only then are the faces numbered as in the loops
+  // of FaceIteration.hpp, which count empty faces.
+  bool    isPacked()                               const;
 
   // If iF is a valid face index, this method returns the number of
   // corners of the face iF. Otherwise it returns 0.
-  int     getFaceSize(const int iF)                const;
+  Index   getFaceSize(const Index iF)              const;
 
   // If iF is a valid face index, this method returns the index of the
   // coordIndex entry corresponding to the first corner of the face
   // iF. Otherwise it returns -1.
-  int     getFaceFirstCorner(const int iF)         const;
+  Index   getFaceFirstCorner(const Index iF)       const;
 
   // If iF is a valid face index, and j is a valid corner index for
   // face iF, this method returns the value stored in the
   // corresponding coordIndex entry.
-  int     getFaceVertex(const int iF, const int j) const;
+  Index   getFaceVertex(const Index iF, const Index j) const;
 
   // If iC is a valid corner index, and it does not correspond to a -1
   // separator, this method returns the index of the face which
   // contains the given corner. Otherwise it returns -1.
-  int     getCornerFace(const int iC)              const;
+  Index   getCornerFace(const Index iC)            const;
+
+  // If iC is a valid corner index, this method returns the value of
+  // coordIndex[iC], which is -1 for separators. Otherwise it returns
+  // -1.
+  Index   getCornerVertex(const Index iC)          const;
 
   // If iC is a valid corner index, and it does not correspond to a -1
   // separator, this method returns the next corner index within the
   // cyclical order of the face which contains the given
   // corner. Otherwise it returns -1.
-  int     getNextCorner(const int iC)              const;
+  Index   getNextCorner(const Index iC)            const;
+
+  // Each corner iC of a face also represents the half edge which
+  // joins its vertex to the vertex of the next corner. The twin
+  // corner table, which is not built by the constructor, matches
+  // the half edges of different faces which join the same two
+  // vertices, in either direction. The table is built in O(nC)
+  // time, plus the time to sort the corners incident to each
+  // vertex, and has to be rebuilt by calling this method again if
+  // the coordIndex array is modified.
+  void    buildTwinCorners();
+  bool    hasTwinCorners()                          const;
+
+  // If the twin corner table has been built, and the edge of corner
+  // iC is shared by exactly two faces, this method returns the
+  // corner of the other face. Otherwise it returns -1.
+  Index   getTwinCorner(const Index iC)            const;
+
+  // If the twin corner table has been built, these methods return
+  // true if the edge of corner iC belongs to exactly one face, or to
+  // more than two faces. Otherwise they return false.
+  bool    isBoundaryEdge(const Index iC)            const;
+  bool    isNonManifoldEdge(const Index iC)         const;
+
+  // The vertex corner table, which is not built by the constructor
+  // either, lists the corners incident to each vertex, in increasing
+  // order, in a compressed sparse row layout. It is built by a
+  // parallel counting sort, and lets per-vertex operations gather
+  // values from the incident corners or faces, rather than
+  // scattering values from the faces to the vertices. It has to be
+  // rebuilt if the coordIndex array is modified.
+  void    buildVertexCorners();
+  bool    hasVertexCorners()                        const;
+
+  // If the vertex corner table has been built, and iV is a valid
+  // vertex index, this method returns the number of corners incident
+  // to vertex iV. Otherwise it returns 0.
+  Index   getVertexSize(const Index iV)            const;
+
+  // If the vertex corner table has been built, iV is a valid vertex
+  // index, and 0<=j<getVertexSize(iV), these methods return the j-th
+  // corner incident to vertex iV, and the face which contains it.
+  // Otherwise they return -1.
+  Index   getVertexCorner(const Index iV, const Index j) const;
+  Index   getVertexFace(const Index iV, const Index j) const;
+
+  // The edge table, which is also built on request, lists each pair
+  // of vertices joined by the edge of at least one corner once,
+  // sorted on the smaller and then on the larger vertex index, along
+  // with the corners, and so the faces, which share the edge. It has
+  // to be rebuilt if the coordIndex array is modified.
+  void    buildEdges();
+  bool    hasEdges()                                const;
+  Index   getNumberOfEdges()                       const;
+
+  // If iE is a valid edge index, and j is 0 or 1, this method returns
+  // the smaller or larger vertex index of the edge. Otherwise it
+  // returns -1.
+  Index   getEdgeVertex(const Index iE, const Index j) const;
+
+  // If iE is a valid edge index, this method returns the number of
+  // face corners which share the edge: 1 for boundary edges, 2 for
+  // regular edges, and more than 2 for non-manifold edges. Otherwise
+  // it returns 0.
+  Index   getEdgeSize(const Index iE)              const;
+
+  // If iE is a valid edge index and 0<=j<getEdgeSize(iE), these
+  // methods return the j-th corner which shares the edge, in
+  // increasing order, and the face which contains it. Otherwise they
+  // return -1.
+  Index   getEdgeCorner(const Index iE, const Index j) const;
+  Index   getEdgeFace(const Index iE, const Index j) const;
 
 private:
-    int _nV;
-    int _nF;
-    vector<int> _coordIndex;
-    vector<int> _faceFirstCorner;
-    vector<int> _cornerFace;
-
 
-  // TODO
+  void _build();
+
+  // face iF owns the corners _faceFirstCorner[iF] through
+  // _faceFirstCorner[iF+1]-2, followed by its -1 separator; the last
+  // entry points one past the separator of the last face (which may
+  // be virtual if coordIndex does not end with -1)
+  Index _faceEnd(const Index iF) const;
+
+  // returns false for separators and corners with negative vertex
+  // indices
+  bool _cornerEdge(const Index iC, Index& vMin, Index& vMax) const;
+
+  size_t _sortEdgeCorners
+  (vector<Index>& first, vector<Index>& corner, vector<Index>& far) const;
+
+  Index         _nV;
+  Index         _nF;
+  bool          _packed;            // no leading or repeated -1 separators
+  Index         _nC;
+  const Index*  _coord;             // owned or borrowed coordIndex
+  vector<Index> _coordIndex;        // empty if borrowed
+  vector<Index> _faceFirstCorner;   // nF+1 offsets
+  vector<Index> _cornerFace;        // nC entries, -1 for separators
+  vector<Index> _cornerTwin;        // empty until built; twin corner,
+                                    // -1 boundary, -2 non-manifold
+  vector<Index> _vertexFirstCorner; // empty until built; nV+1 offsets
+  vector<Index> _vertexCorner;
+  vector<Index> _edgeVertex;        // empty until built; 2 per edge
+  vector<Index> _edgeFirstCorner;   // nE+1 offsets
+  vector<Index> _edgeCorner;
 
 };
 
+typedef FacesT<int32_t> Faces;
+typedef FacesT<int64_t> Faces64;
+
 #endif /* _FACES_HPP_ */
@@ -0,0 +1,306 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// MeshAnalysis.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "MeshAnalysis.hpp"
+#include "util/Parallel.hpp"
+#include "util/UnionFind.hpp"
+
+MeshAnalysis::MeshAnalysis():
+  _nV(0),
+  _nF(0),
+  _nE(0),
+  _nBoundaryEdges(0),
+  _nNonManifoldEdges(0),
+  _nNonManifoldVertices(0),
+  _nInconsistentEdges(0),
+  _nComponents(0) {
+}
+
+// Splits the range [0,n) into the blocks of Parallel::forRange(), or
+// into a single block if the range is small.
+
+template <class Index>
+static size_t _split(const Index n, vector<Index>& cut) {
+  return Parallel::split((size_t)n,Parallel::getGrain((size_t)n,0,1u<<20),cut);
+}
+
+static size_t _sum(const vector<size_t>& count) {
+  size_t sum = 0;
+  for(size_t i=0;i<count.size();i++)
+    sum += count[i];
+  return sum;
+}
+
+template <class Index>
+MeshAnalysis::MeshAnalysis(FacesT<Index>& faces):
+  MeshAnalysis() {
+
+  if(faces.hasEdges()==false) faces.buildEdges();
+
+  const Index nV = faces.getNumberOfVertices();
+  const Index nF = faces.getNumberOfFaces();
+  const Index nC = faces.getNumberOfCorners();
+  const Index nE = faces.getNumberOfEdges();
+  _nV = (size_t)nV;
+  _nF = (size_t)nF;
+  _nE = (size_t)nE;
+
+  UnionFind<Index> faceSets(nF);
+  UnionFind<Index> cornerSets(nC);
+  vector<Index> cut;
+
+  // classify the edges, join the faces which share each edge, and
+  // join the corners which belong to the same vertex fan across each
+  // regular edge
+  size_t nChunks = _split(nE,cut);
+  vector<size_t> nBoundary(nChunks,0);
+  vector<size_t> nNonManifold(nChunks,0);
+  vector<size_t> nInconsistent(nChunks,0);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    for(Index iE=cut[i];iE<cut[i+1];iE++) {
+      const Index n   = faces.getEdgeSize(iE);
+      const Index iC0 = faces.getEdgeCorner(iE,0);
+      const Index iF0 = faces.getCornerFace(iC0);
+      for(Index j=1;j<n;j++)
+        faceSets.join(iF0,faces.getEdgeFace(iE,j));
+      if(n==1) {
+        nBoundary[i]++;
+      } else if(n>2) {
+        nNonManifold[i]++;
+      } else if(faces.getEdgeVertex(iE,0)!=faces.getEdgeVertex(iE,1)) {
+        const Index iC1 = faces.getEdgeCorner(iE,1);
+        const Index iN0 = faces.getNextCorner(iC0);
+        const Index iN1 = faces.getNextCorner(iC1);
+        if(faces.getCornerVertex(iC0)==faces.getCornerVertex(iC1)) {
+          // both faces traverse the edge in the same direction
+          nInconsistent[i]++;
+          cornerSets.join(iC0,iC1);
+          cornerSets.join(iN0,iN1);
+        } else {
+          cornerSets.join(iC0,iN1);
+          cornerSets.join(iN0,iC1);
+        }
+      }
+    }
+  });
+  _nBoundaryEdges     = _sum(nBoundary);
+  _nNonManifoldEdges  = _sum(nNonManifold);
+  _nInconsistentEdges = _sum(nInconsistent);
+
+  // the root of one of the corners of each vertex is stored first;
+  // then the vertices which have corners in any other fan are marked
+  // with -2, and counted
+  vector<atomic<Index> > vertexFan((size_t)nV);
+  nChunks = _split(nV,cut);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    for(Index iV=cut[i];iV<cut[i+1];iV++)
+      vertexFan[iV].store(-1,memory_order_relaxed);
+  });
+  vector<Index> cornerCut;
+  size_t nCornerChunks = _split(nC,cornerCut);
+  Parallel::forEach(nCornerChunks,[&](size_t i) {
+    for(Index iC=cornerCut[i];iC<cornerCut[i+1];iC++) {
+      const Index iV = faces.getCornerVertex(iC);
+      if(iV>=0) vertexFan[iV].store(cornerSets.find(iC),memory_order_relaxed);
+    }
+  });
+  Parallel::forEach(nCornerChunks,[&](size_t i) {
+    for(Index iC=cornerCut[i];iC<cornerCut[i+1];iC++) {
+      const Index iV = faces.getCornerVertex(iC);
+      if(iV<0) continue;
+      Index fan = vertexFan[iV].load(memory_order_relaxed);
+      if(fan!=-2 && fan!=cornerSets.find(iC))
+        vertexFan[iV].compare_exchange_strong(fan,-2,memory_order_relaxed);
+    }
+  });
+  vector<size_t> nNonManifoldVertices(nChunks,0);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    for(Index iV=cut[i];iV<cut[i+1];iV++)
+      if(vertexFan[iV].load(memory_order_relaxed)==-2)
+        nNonManifoldVertices[i]++;
+  });
+  _nNonManifoldVertices = _sum(nNonManifoldVertices);
+
+  // each component is represented by its smallest face
+  nChunks = _split(nF,cut);
+  vector<size_t> nComponents(nChunks,0);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    for(Index iF=cut[i];iF<cut[i+1];iF++)
+      if(faceSets.isRoot(iF) && faces.getFaceSize(iF)>0)
+        nComponents[i]++;
+  });
+  _nComponents = _sum(nComponents);
+}
+
+template <class Index>
+Index MeshAnalysis::labelComponents
+(FacesT<Index>& faces, vector<Index>& faceComponent) {
+
+  if(faces.hasEdges()==false) faces.buildEdges();
+
+  const Index nF = faces.getNumberOfFaces();
+  const Index nE = faces.getNumberOfEdges();
+
+  UnionFind<Index> faceSets(nF);
+  vector<Index> cut;
+
+  size_t nChunks = _split(nE,cut);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    for(Index iE=cut[i];iE<cut[i+1];iE++) {
+      const Index n   = faces.getEdgeSize(iE);
+      const Index iF0 = faces.getEdgeFace(iE,0);
+      for(Index j=1;j<n;j++)
+        faceSets.join(iF0,faces.getEdgeFace(iE,j));
+    }
+  });
+
+  // the roots, which are the first faces of their components, are
+  // numbered first, and the other faces then copy the number of
+  // their root
+  faceComponent.resize((size_t)nF);
+  nChunks = _split(nF,cut);
+  vector<Index> first(nChunks+1,0);
+  Parallel::forEach(nChunks,[&](size_t i) {
+    Index n = 0;
+    for(Index iF=cut[i];iF<cut[i+1];iF++)
+      if(faceSets.isRoot(iF) && faces.getFaceSize(iF)>0)
+        n++;
+    first[i+1] = n;
+  });
+  for(size_t i=0;i<nChunks;i++)
+    first[i+1] += first[i];
+  Parallel::forEach(nChunks,[&](size_t i) {
+    Index k = first[i];
+    for(Index iF=cut[i];iF<cut[i+1];iF++)
+      faceComponent[iF] =
+        (faceSets.isRoot(iF) && faces.getFaceSize(iF)>0)?k++:-1;
+  });
+  Parallel::forEach(nChunks,[&](size_t i) {
+    for(Index iF=cut[i];iF<cut[i+1];iF++)
+      if(faceComponent[iF]<0 && faces.getFaceSize(iF)>0)
+        faceComponent[iF] = faceComponent[faceSets.find(iF)];
+  });
+
+  return first[nChunks];
+}
+
+MeshAnalysis& MeshAnalysis::operator+=(const MeshAnalysis& analysis) {
+  _nV                   += analysis._nV;
+  _nF                   += analysis._nF;
+  _nE                   += analysis._nE;
+  _nBoundaryEdges       += analysis._nBoundaryEdges;
+  _nNonManifoldEdges    += analysis._nNonManifoldEdges;
+  _nNonManifoldVertices += analysis._nNonManifoldVertices;
+  _nInconsistentEdges   += analysis._nInconsistentEdges;
+  _nComponents          += analysis._nComponents;
+  return *this;
+}
+
+size_t MeshAnalysis::getNumberOfVertices() const {
+  return _nV;
+}
+
+size_t MeshAnalysis::getNumberOfFaces() const {
+  return _nF;
+}
+
+size_t MeshAnalysis::getNumberOfEdges() const {
+  return _nE;
+}
+
+size_t MeshAnalysis::getNumberOfBoundaryEdges() const {
+  return _nBoundaryEdges;
+}
+
+size_t MeshAnalysis::getNumberOfNonManifoldEdges() const {
+  return _nNonManifoldEdges;
+}
+
+size_t MeshAnalysis::getNumberOfNonManifoldVertices() const {
+  return _nNonManifoldVertices;
+}
+
+size_t MeshAnalysis::getNumberOfInconsistentEdges() const {
+  return _nInconsistentEdges;
+}
+
+size_t MeshAnalysis::getNumberOfComponents() const {
+  return _nComponents;
+}
+
+bool MeshAnalysis::isClosed() const {
+  return (_nBoundaryEdges==0);
+}
+
+bool MeshAnalysis::isManifold() const {
+  return (_nNonManifoldEdges==0 && _nNonManifoldVertices==0);
+}
+
+bool MeshAnalysis::isOriented() const {
+  return (_nInconsistentEdges==0);
+}
+
+bool MeshAnalysis::isWatertight() const {
+  return isClosed() && isManifold() && isOriented();
+}
+
+void MeshAnalysis::printInfo(ostream& os, const string& indent) const {
+  const char* yes = "true";
+  const char* no  = "false";
+  os << indent << "vertices              = " << _nV << endl;
+  os << indent << "faces                 = " << _nF << endl;
+  os << indent << "edges                 = " << _nE << endl;
+  os << indent << "boundary edges        = " << _nBoundaryEdges << endl;
+  os << indent << "non-manifold edges    = " << _nNonManifoldEdges << endl;
+  os << indent << "non-manifold vertices = " << _nNonManifoldVertices << endl;
+  os << indent << "inconsistent edges    = " << _nInconsistentEdges << endl;
+  os << indent << "components            = " << _nComponents << endl;
+  os << indent << "closed                = " << (isClosed()?yes:no) << endl;
+  os << indent << "manifold              = " << (isManifold()?yes:no) << endl;
+  os << indent << "oriented              = " << (isOriented()?yes:no) << endl;
+  os << indent << "watertight            = " << (isWatertight()?yes:no) << endl;
+}
+
+// the index types supported by the Faces class
+template MeshAnalysis::MeshAnalysis(FacesT<int32_t>& faces);
+template MeshAnalysis::MeshAnalysis(FacesT<int64_t>& faces);
+template int32_t MeshAnalysis::labelComponents
+(FacesT<int32_t>& faces, vector<int32_t>& faceComponent);
+template int64_t MeshAnalysis::labelComponents
+(FacesT<int64_t>& faces, vector<int64_t>& faceComponent);
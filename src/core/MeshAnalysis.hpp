@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// MeshAnalysis.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _MESH_ANALYSIS_HPP_
+#define _MESH_ANALYSIS_HPP_
+
+#include <stddef.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Faces.hpp"
+
+using namespace std;
+
+// Topological analysis of a polygon mesh, which tells whether it can
+// be sent to a printer as it is: closed, manifold, and consistently
+// oriented. The counts are computed from the edge table of the Faces
+// class, which is built in parallel if necessary, and from two
+// lock-free union-find structures, one over the corners, to split the
+// corners incident to each vertex into fans, and one over the faces,
+// to count the connected components.
+//
+// - a boundary edge belongs to exactly one face
+// - a non-manifold edge belongs to more than two faces
+// - a non-manifold vertex is incident to more than one fan of faces
+//   connected through the regular edges incident to the vertex; the
+//   vertices of non-manifold edges are non-manifold as well
+// - a regular edge, which belongs to two faces, is inconsistently
+//   oriented if both faces traverse it in the same direction
+// - two faces belong to the same connected component if they are
+//   joined by a path of faces in which consecutive faces share an
+//   edge; empty faces are not counted
+//
+// Edges which join a vertex to itself, which only appear in faces
+// with repeated vertices, are counted as edges, but not as
+// inconsistently oriented. Analyses of several meshes can be added
+// together, and the counts then describe their union.
+
+class MeshAnalysis {
+
+public:
+
+  MeshAnalysis();
+  template <class Index>
+  MeshAnalysis(FacesT<Index>& faces);
+
+  MeshAnalysis& operator+=(const MeshAnalysis& analysis);
+
+  size_t getNumberOfVertices()              const;
+  size_t getNumberOfFaces()                 const;
+  size_t getNumberOfEdges()                 const;
+  size_t getNumberOfBoundaryEdges()         const;
+  size_t getNumberOfNonManifoldEdges()      const;
+  size_t getNumberOfNonManifoldVertices()   const;
+  size_t getNumberOfInconsistentEdges()     const;
+  size_t getNumberOfComponents()            const;
+
+  // no boundary edges
+  bool   isClosed()                         const;
+  // no non-manifold edges or vertices
+  bool   isManifold()                       const;
+  // no inconsistently oriented edges
+  bool   isOriented()                       const;
+  // closed, manifold, and oriented
+  bool   isWatertight()                     const;
+
+  void   printInfo(ostream& os, const string& indent) const;
+
+  // Sets faceComponent[iF] to the index of the connected component
+  // of each face iF, or to -1 for empty faces, and returns the number
+  // of components. The components are numbered in the order of their
+  // first faces, so the result does not depend on the number of
+  // threads.
+  template <class Index>
+  static Index labelComponents
+  (FacesT<Index>& faces, vector<Index>& faceComponent);
+
+private:
+
+  size_t _nV;
+  size_t _nF;
+  size_t _nE;
+  size_t _nBoundaryEdges;
+  size_t _nNonManifoldEdges;
+  size_t _nNonManifoldVertices;
+  size_t _nInconsistentEdges;
+  size_t _nComponents;
+
+};
+
+#endif /* _MESH_ANALYSIS_HPP_ */
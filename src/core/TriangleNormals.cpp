@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// TriangleNormals.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include "TriangleNormals.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _TRIANGLE_NORMALS_X86_
+#include <immintrin.h>
+#endif
+
+// the per face normal of SceneGraphProcessor, for triangles
+template <class Index>
+static inline void _normal
+(const float* coord, const Index* ci, float* n) {
+  const float* p  = coord+3*(size_t)ci[0];
+  const float* p1 = coord+3*(size_t)ci[1];
+  const float* p2 = coord+3*(size_t)ci[2];
+  float v1[3] = { p1[0]-p[0], p1[1]-p[1], p1[2]-p[2] };
+  float v2[3] = { p2[0]-p[0], p2[1]-p[1], p2[2]-p[2] };
+  n[0] = v1[1]*v2[2]-v1[2]*v2[1];
+  n[1] = v1[2]*v2[0]-v1[0]*v2[2];
+  n[2] = v1[0]*v2[1]-v1[1]*v2[0];
+  float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
+  if(nn>0.0f) {
+    nn = (float)sqrt(nn);
+    n[0] /= nn; n[1] /= nn; n[2] /= nn;
+  }
+}
+
+template <class Index>
+static void _computeScalar
+(const float* coord, const Index* coordIndex, const size_t nT,
+ float* normal) {
+  for(size_t iT=0;iT<nT;iT++)
+    _normal(coord,coordIndex+4*iT,normal+3*iT);
+}
+
+#ifdef _TRIANGLE_NORMALS_X86_
+
+// the normalized normals of a block of nL triangles, starting at iT,
+// are stored from the SoA registers into the AoS normal array;
+// triangles with tiny or null normals are recomputed by the scalar
+// code
+static inline void _storeBlock
+(const float* coord, const int32_t* coordIndex, const size_t iT,
+ const int nL, const float* nx, const float* ny, const float* nz,
+ const int tiny, float* normal) {
+  float* n = normal+3*iT;
+  for(int l=0;l<nL;l++,n+=3) {
+    if(tiny&(1<<l)) {
+      _normal(coord,coordIndex+4*(iT+l),n);
+    } else {
+      n[0] = nx[l]; n[1] = ny[l]; n[2] = nz[l];
+    }
+  }
+}
+
+// the last block of a vector kernel is filled up by repeating its
+// last triangle, so that every triangle is computed by the same code,
+// wherever the caller splits the mesh
+static inline const int32_t* _padBlock
+(const int32_t* coordIndex, const size_t iT, const size_t nT,
+ const int nL, int32_t* pad) {
+  if(iT+nL<=nT) return coordIndex+4*iT;
+  for(int l=0;l<nL;l++) {
+    const int32_t* ci = coordIndex+4*((iT+l<nT)?iT+l:nT-1);
+    for(int j=0;j<3;j++) pad[4*l+j] = ci[j];
+    pad[4*l+3] = -1;
+  }
+  return pad;
+}
+
+__attribute__((target("sse2")))
+static void _computeSse
+(const float* coord, const int32_t* coordIndex, const size_t nT,
+ float* normal) {
+  const __m128 half    = _mm_set1_ps(0.5f);
+  const __m128 three2  = _mm_set1_ps(1.5f);
+  const __m128 fltMin  = _mm_set1_ps(FLT_MIN);
+  float x[3][4],y[3][4],z[3][4];
+  float nx[4],ny[4],nz[4];
+  int32_t pad[16];
+  for(size_t iT=0;iT<nT;iT+=4) {
+    // gather the coordinates of the 4 triangles, one register per
+    // coordinate of each vertex
+    const int32_t* ci = _padBlock(coordIndex,iT,nT,4,pad);
+    for(int l=0;l<4;l++,ci+=4)
+      for(int j=0;j<3;j++) {
+        const float* p = coord+3*(size_t)ci[j];
+        x[j][l] = p[0]; y[j][l] = p[1]; z[j][l] = p[2];
+      }
+    __m128 x0 = _mm_loadu_ps(x[0]), y0 = _mm_loadu_ps(y[0]), z0 = _mm_loadu_ps(z[0]);
+    __m128 ux = _mm_sub_ps(_mm_loadu_ps(x[1]),x0);
+    __m128 uy = _mm_sub_ps(_mm_loadu_ps(y[1]),y0);
+    __m128 uz = _mm_sub_ps(_mm_loadu_ps(z[1]),z0);
+    __m128 vx = _mm_sub_ps(_mm_loadu_ps(x[2]),x0);
+    __m128 vy = _mm_sub_ps(_mm_loadu_ps(y[2]),y0);
+    __m128 vz = _mm_sub_ps(_mm_loadu_ps(z[2]),z0);
+    __m128 cx = _mm_sub_ps(_mm_mul_ps(uy,vz),_mm_mul_ps(uz,vy));
+    __m128 cy = _mm_sub_ps(_mm_mul_ps(uz,vx),_mm_mul_ps(ux,vz));
+    __m128 cz = _mm_sub_ps(_mm_mul_ps(ux,vy),_mm_mul_ps(uy,vx));
+    __m128 nn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx,cx),_mm_mul_ps(cy,cy)),
+                           _mm_mul_ps(cz,cz));
+    // r = 1/sqrt(nn), refined by one Newton step
+    __m128 r  = _mm_rsqrt_ps(nn);
+    r = _mm_mul_ps(r,_mm_sub_ps(three2,
+                                _mm_mul_ps(_mm_mul_ps(half,nn),_mm_mul_ps(r,r))));
+    _mm_storeu_ps(nx,_mm_mul_ps(cx,r));
+    _mm_storeu_ps(ny,_mm_mul_ps(cy,r));
+    _mm_storeu_ps(nz,_mm_mul_ps(cz,r));
+    int tiny = _mm_movemask_ps(_mm_cmplt_ps(nn,fltMin));
+    _storeBlock(coord,coordIndex,iT,(nT-iT<4)?(int)(nT-iT):4,nx,ny,nz,tiny,normal);
+  }
+}
+
+__attribute__((target("avx2")))
+static void _computeAvx2
+(const float* coord, const int32_t* coordIndex, const size_t nT,
+ float* normal) {
+  const __m256  half    = _mm256_set1_ps(0.5f);
+  const __m256  three2  = _mm256_set1_ps(1.5f);
+  const __m256  fltMin  = _mm256_set1_ps(FLT_MIN);
+  const __m256i three   = _mm256_set1_epi32(3);
+  const __m256i stride  = _mm256_setr_epi32(0,4,8,12,16,20,24,28);
+  float nx[8],ny[8],nz[8];
+  int32_t pad[32];
+  for(size_t iT=0;iT<nT;iT+=8) {
+    // gather the vertex indices of the 8 triangles, and then their
+    // coordinates, one register per coordinate of each vertex
+    const int32_t* ci = _padBlock(coordIndex,iT,nT,8,pad);
+    __m256i i0 = _mm256_mullo_epi32(_mm256_i32gather_epi32(ci  ,stride,4),three);
+    __m256i i1 = _mm256_mullo_epi32(_mm256_i32gather_epi32(ci+1,stride,4),three);
+    __m256i i2 = _mm256_mullo_epi32(_mm256_i32gather_epi32(ci+2,stride,4),three);
+    __m256 x0 = _mm256_i32gather_ps(coord  ,i0,4);
+    __m256 y0 = _mm256_i32gather_ps(coord+1,i0,4);
+    __m256 z0 = _mm256_i32gather_ps(coord+2,i0,4);
+    __m256 ux = _mm256_sub_ps(_mm256_i32gather_ps(coord  ,i1,4),x0);
+    __m256 uy = _mm256_sub_ps(_mm256_i32gather_ps(coord+1,i1,4),y0);
+    __m256 uz = _mm256_sub_ps(_mm256_i32gather_ps(coord+2,i1,4),z0);
+    __m256 vx = _mm256_sub_ps(_mm256_i32gather_ps(coord  ,i2,4),x0);
+    __m256 vy = _mm256_sub_ps(_mm256_i32gather_ps(coord+1,i2,4),y0);
+    __m256 vz = _mm256_sub_ps(_mm256_i32gather_ps(coord+2,i2,4),z0);
+    // no fused multiply-add, so that the cross products have the same
+    // bits as in the scalar code
+    __m256 cx = _mm256_sub_ps(_mm256_mul_ps(uy,vz),_mm256_mul_ps(uz,vy));
+    __m256 cy = _mm256_sub_ps(_mm256_mul_ps(uz,vx),_mm256_mul_ps(ux,vz));
+    __m256 cz = _mm256_sub_ps(_mm256_mul_ps(ux,vy),_mm256_mul_ps(uy,vx));
+    __m256 nn = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx,cx),
+                                            _mm256_mul_ps(cy,cy)),
+                              _mm256_mul_ps(cz,cz));
+    // r = 1/sqrt(nn), refined by one Newton step
+    __m256 r  = _mm256_rsqrt_ps(nn);
+    r = _mm256_mul_ps(r,_mm256_sub_ps(three2,
+                                      _mm256_mul_ps(_mm256_mul_ps(half,nn),
+                                                    _mm256_mul_ps(r,r))));
+    _mm256_storeu_ps(nx,_mm256_mul_ps(cx,r));
+    _mm256_storeu_ps(ny,_mm256_mul_ps(cy,r));
+    _mm256_storeu_ps(nz,_mm256_mul_ps(cz,r));
+    int tiny = _mm256_movemask_ps(_mm256_cmp_ps(nn,fltMin,_CMP_LT_OQ));
+    _storeBlock(coord,coordIndex,iT,(nT-iT<8)?(int)(nT-iT):8,nx,ny,nz,tiny,normal);
+  }
+}
+
+#endif /* _TRIANGLE_NORMALS_X86_ */
+
+static TriangleNormals::Kernel _bestKernel() {
+#ifdef _TRIANGLE_NORMALS_X86_
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) return TriangleNormals::AVX2;
+  if(__builtin_cpu_supports("sse2")) return TriangleNormals::SSE;
+#endif
+  return TriangleNormals::SCALAR;
+}
+
+static TriangleNormals::Kernel _kernel = _bestKernel();
+
+TriangleNormals::Kernel TriangleNormals::getKernel() {
+  return _kernel;
+}
+
+void TriangleNormals::setKernel(const Kernel kernel) {
+  Kernel best = _bestKernel();
+  _kernel = (kernel<best)?kernel:best;
+}
+
+const char* TriangleNormals::getKernelName(const Kernel kernel) {
+  switch(kernel) {
+  case AVX2: return "AVX2";
+  case SSE:  return "SSE";
+  default:   return "SCALAR";
+  }
+}
+
+void TriangleNormals::compute
+(const float* coord, const size_t nV,
+ const int32_t* coordIndex, const size_t nT, float* normal) {
+#ifdef _TRIANGLE_NORMALS_X86_
+  // the gathers address the coordinates with 32 bit offsets
+  if(3*nV<=(size_t)INT_MAX) {
+    if(_kernel==AVX2) {
+      _computeAvx2(coord,coordIndex,nT,normal);
+      return;
+    }
+    if(_kernel==SSE) {
+      _computeSse(coord,coordIndex,nT,normal);
+      return;
+    }
+  }
+#else
+  (void)nV;
+#endif
+  _computeScalar(coord,coordIndex,nT,normal);
+}
+
+void TriangleNormals::compute
+(const float* coord, const size_t /*nV*/,
+ const int64_t* coordIndex, const size_t nT, float* normal) {
+  _computeScalar(coord,coordIndex,nT,normal);
+}
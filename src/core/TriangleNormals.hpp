@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// TriangleNormals.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _TRIANGLE_NORMALS_HPP_
+#define _TRIANGLE_NORMALS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace std;
+
+// Unit normals of the triangles of a triangle mesh, whose coordIndex
+// array lists three vertex indices and a separator for each triangle,
+// as tested by isTriangleMesh(). With 32 bit indices the triangles
+// are processed in blocks of 8 (AVX2) or 4 (SSE): the vertex
+// coordinates are gathered into one register per coordinate, the
+// cross products are computed across the block, and the normals are
+// scaled by a hardware reciprocal square root refined by one Newton
+// step; the last block is filled up with copies of its last
+// triangle, so that the normal of each triangle does not depend on
+// where the caller splits the array. The kernel is selected at
+// runtime, from what the processor supports; the scalar kernel, used
+// on other processors and for 64 bit indices, computes the same bits
+// as the per face normal loop of SceneGraphProcessor.
+//
+// The cross products are the same in all kernels. The normalization
+// of the vector kernels differs from a division by the square root in
+// the last bits only: the relative error of each component is below
+// 1e-6, so the length of each normal is 1 within 1e-6, and depends on
+// the processor, since the precision of the reciprocal square root is
+// not specified exactly. Triangles whose squared normal length is
+// below FLT_MIN, including degenerate ones, are normalized by the
+// scalar code, and degenerate triangles get a null normal.
+
+class TriangleNormals {
+
+public:
+
+  enum Kernel {
+    SCALAR = 0,
+    SSE    = 1,
+    AVX2   = 2
+  };
+
+  // the fastest kernel supported by the processor, unless another one
+  // has been set
+  static Kernel      getKernel();
+  // kernels not supported by the processor are replaced by the
+  // fastest supported one
+  static void        setKernel(const Kernel kernel);
+  static const char* getKernelName(const Kernel kernel);
+
+  // writes the unit normal of triangle iT, whose vertex indices are
+  // coordIndex[4*iT+j], for j=0,1,2, into normal[3*iT+j], for
+  // 0<=iT<nT; coord holds the 3*nV vertex coordinates
+  static void compute
+  (const float* coord, const size_t nV,
+   const int32_t* coordIndex, const size_t nT, float* normal);
+  static void compute
+  (const float* coord, const size_t nV,
+   const int64_t* coordIndex, const size_t nT, float* normal);
+
+};
+
+#endif /* _TRIANGLE_NORMALS_HPP_ */
@@ -53,6 +53,9 @@
 #include "io/LoaderStl.hpp"
 #include "io/SaverStl.hpp"
 
+#include "io/LoaderSgb.hpp"
+#include "io/SaverSgb.hpp"
+
 int     GuiMainWindow::_timerInterval = 20;
 int     GuiMainWindow::_lDPI          = 96;
 QString GuiMainWindow::_platformName  = "unknown";
@@ -74,6 +77,11 @@ GuiMainWindow::GuiMainWindow(QWidget* parent):
   SaverStl* stlSaver = new SaverStl();
   _saver.registerSaver(stlSaver);
 
+  LoaderSgb* sgbLoader = new LoaderSgb();
+  _loader.registerLoader(sgbLoader);
+  SaverSgb* sgbSaver = new SaverSgb();
+  _saver.registerSaver(sgbSaver);
+
   // for animation
   _timer = new QTimer(this);
   _timer->setInterval(_timerInterval);
@@ -142,7 +150,7 @@ void GuiMainWindow::on_fileLoadAction_triggered() {
   QFileDialog fileDialog(this);
   fileDialog.setFileMode(QFileDialog::ExistingFile); // allowed to select only one 
   fileDialog.setAcceptMode(QFileDialog::AcceptOpen);
-  fileDialog.setNameFilter(tr("3D Files (*.wrl *.stl)"));
+  fileDialog.setNameFilter(tr("3D Files (*.wrl *.stl *.sgb)"));
   QStringList fileNames;
   if(fileDialog.exec()) {
     fileNames = fileDialog.selectedFiles();
@@ -175,7 +183,7 @@ void GuiMainWindow::on_fileSaveAction_triggered() {
   // TODO Sat Sep 10 22:18:57 2016
   // get list of file extensions from registered Savers
 
-  fileDialog.setNameFilter(tr("3D Files (*.wrl *.stl)"));
+  fileDialog.setNameFilter(tr("3D Files (*.wrl *.stl *.sgb)"));
   QStringList fileNames;
   if(fileDialog.exec()) {
     fileNames = fileDialog.selectedFiles();
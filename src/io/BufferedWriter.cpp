@@ -0,0 +1,226 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// BufferedWriter.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <charconv>
+#include <vector>
+#include "BufferedWriter.hpp"
+
+// floats are formatted into a temporary buffer of this size; fixed
+// notation needs at most 39 digits before the decimal point
+static const size_t _maxFloatLength = 64;
+
+BufferedWriter::BufferedWriter(FILE* fp, const size_t bufferSize):
+  _fp(fp),
+  _begin((char*)0),
+  _end((char*)0),
+  _pos((char*)0),
+  _ok(true) {
+  size_t size = (bufferSize<256)?256:bufferSize;
+  _begin = (char*)malloc(size);
+  _end   = _begin+size;
+  _pos   = _begin;
+}
+
+BufferedWriter::~BufferedWriter() {
+  flush();
+  free(_begin);
+}
+
+void BufferedWriter::flush() {
+  if(_fp!=(FILE*)0 && _pos>_begin) {
+    size_t n = (size_t)(_pos-_begin);
+    if(fwrite(_begin,1,n,_fp)!=n) _ok = false;
+    _pos = _begin;
+  }
+}
+
+bool BufferedWriter::isOk() const {
+  return _ok;
+}
+
+const char* BufferedWriter::getData() const {
+  return _begin;
+}
+
+size_t BufferedWriter::getSize() const {
+  return (size_t)(_pos-_begin);
+}
+
+void BufferedWriter::clear() {
+  _pos = _begin;
+}
+
+void BufferedWriter::_reserve(const size_t n) {
+  if((size_t)(_end-_pos)>=n) return;
+  if(_fp!=(FILE*)0) {
+    flush();
+    if((size_t)(_end-_pos)>=n) return;
+  }
+  size_t used = (size_t)(_pos-_begin);
+  size_t size = (size_t)(_end-_begin);
+  while(size-used<n) size *= 2;
+  _begin = (char*)realloc(_begin,size);
+  _end   = _begin+size;
+  _pos   = _begin+used;
+}
+
+void BufferedWriter::put(const char c) {
+  if(_pos==_end) _reserve(1);
+  *_pos++ = c;
+}
+
+void BufferedWriter::write(const char* str) {
+  if(str!=(char*)0) write(str,strlen(str));
+}
+
+void BufferedWriter::write(const char* str, const size_t n) {
+  // large blocks are written to the file directly
+  if(_fp!=(FILE*)0 && n>=(size_t)(_end-_begin)/2) {
+    flush();
+    if(fwrite(str,1,n,_fp)!=n) _ok = false;
+    return;
+  }
+  _reserve(n);
+  memcpy(_pos,str,n);
+  _pos += n;
+}
+
+void BufferedWriter::write(const string& str) {
+  write(str.data(),str.size());
+}
+
+void BufferedWriter::_pad(const size_t length, const int width) {
+  if(width>0 && length<(size_t)width) {
+    size_t n = (size_t)width-length;
+    _reserve(n);
+    memset(_pos,' ',n);
+    _pos += n;
+  }
+}
+
+// writes the digits of the absolute value of u, and the sign if u
+// is negative, backwards from end, and returns the first character;
+// the unsigned type is chosen so that 32 bit values are converted
+// with 32 bit divisions
+template <class Signed, class Unsigned>
+static char* _formatInt(const Signed i, char* end) {
+  // digits are generated backwards, two at a time
+  static const char* digits =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+  char* p = end;
+  Unsigned u = (i<0)?(Unsigned)0-(Unsigned)i:(Unsigned)i;
+  while(u>=100) {
+    Unsigned r = u%100;
+    u /= 100;
+    p -= 2;
+    memcpy(p,digits+2*r,2);
+  }
+  if(u>=10) {
+    p -= 2;
+    memcpy(p,digits+2*u,2);
+  } else {
+    *--p = (char)('0'+u);
+  }
+  if(i<0) *--p = '-';
+  return p;
+}
+
+void BufferedWriter::writeInt(const int i, const int width) {
+  char  tmp[16];
+  char* end = tmp+sizeof(tmp);
+  char* p   = _formatInt<int,unsigned int>(i,end);
+  size_t n = (size_t)(end-p);
+  _pad(n,width);
+  write(p,n);
+}
+
+void BufferedWriter::writeInt(const int64_t i, const int width) {
+  char  tmp[24];
+  char* end = tmp+sizeof(tmp);
+  char* p   = _formatInt<int64_t,uint64_t>(i,end);
+  size_t n = (size_t)(end-p);
+  _pad(n,width);
+  write(p,n);
+}
+
+// For precision<=8 the product of a float and 10^precision is exact
+// in double precision, so rounding it to the nearest integer, with
+// ties to even as printf does, gives the digits to be printed.
+static const double _pow10[9] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8
+};
+
+void BufferedWriter::writeFloat(const float f, const int precision, const int width) {
+  char tmp[_maxFloatLength];
+  if(precision>=0 && precision<=8 && isfinite(f)) {
+    double x = fabs((double)f)*_pow10[precision];
+    if(x<4.0e15) {
+      uint64_t n = (uint64_t)nearbyint(x);
+      char* end = tmp+sizeof(tmp);
+      char* p   = end;
+      for(int k=0;k<precision;k++,n/=10)
+        *--p = (char)('0'+n%10);
+      if(precision>0) *--p = '.';
+      do { *--p = (char)('0'+n%10); n /= 10; } while(n>0);
+      if(signbit(f)) *--p = '-';
+      size_t len = (size_t)(end-p);
+      _pad(len,width);
+      write(p,len);
+      return;
+    }
+  }
+  std::to_chars_result r = (precision>=0)?
+    std::to_chars(tmp,tmp+sizeof(tmp),f,std::chars_format::fixed,precision):
+    std::to_chars(tmp,tmp+sizeof(tmp),f);
+  if(r.ec!=std::errc()) {
+    // only possible for very large precisions
+    int n = snprintf((char*)0,0,"%*.*f",width,precision,(double)f);
+    if(n>0) {
+      vector<char> s((size_t)n+1);
+      snprintf(s.data(),s.size(),"%*.*f",width,precision,(double)f);
+      write(s.data(),(size_t)n);
+    }
+    return;
+  }
+  size_t n = (size_t)(r.ptr-tmp);
+  _pad(n,width);
+  write(tmp,n);
+}
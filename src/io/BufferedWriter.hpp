@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// BufferedWriter.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _BUFFERED_WRITER_HPP_
+#define _BUFFERED_WRITER_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+// Text output for the savers. Characters are accumulated in a buffer
+// owned by the writer, and numbers are formatted directly into it,
+// without parsing printf format strings.
+//
+// If constructed with a FILE*, the buffer is written to the file
+// whenever it fills up, and when flush() is called or the writer is
+// destroyed; the file is not closed by the writer. Otherwise the
+// buffer grows as needed, and its contents can be retrieved with
+// getData() and getSize().
+
+class BufferedWriter {
+
+public:
+
+  BufferedWriter(FILE* fp=(FILE*)0, const size_t bufferSize=1<<20);
+  ~BufferedWriter();
+
+  // writes the buffer to the file, if any
+  void        flush();
+  // false after a failed write to the file
+  bool        isOk() const;
+
+  const char* getData() const;
+  size_t      getSize() const;
+  void        clear();
+
+  void        put(const char c);
+  void        write(const char* str);
+  void        write(const char* str, const size_t n);
+  void        write(const string& str);
+
+  // equivalent to fprintf(fp,"%*d",width,i)
+  void        writeInt(const int i, const int width=0);
+  void        writeInt(const int64_t i, const int width=0);
+  // equivalent to fprintf(fp,"%*.*f",width,precision,f) if
+  // precision>=0; otherwise the shortest representation which reads
+  // back as the same float is written
+  void        writeFloat(const float f, const int precision=-1, const int width=0);
+
+private:
+
+  BufferedWriter(const BufferedWriter&);
+  BufferedWriter& operator=(const BufferedWriter&);
+
+  // makes room for at least n more characters
+  void        _reserve(const size_t n);
+  void        _pad(const size_t length, const int width);
+
+  FILE*  _fp;
+  char*  _begin;
+  char*  _end;
+  char*  _pos;
+  bool   _ok;
+
+};
+
+#endif /* _BUFFERED_WRITER_HPP_ */
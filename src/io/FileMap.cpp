@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// FileMap.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "FileMap.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// returned by getData() for open empty files
+static const char _empty[1] = { '\0' };
+
+FileMap::FileMap():
+  _data((const char*)0),
+  _size(0),
+  _handle((void*)0),
+  _mapping((void*)0) {
+}
+
+FileMap::FileMap(const char* filename):
+  _data((const char*)0),
+  _size(0),
+  _handle((void*)0),
+  _mapping((void*)0) {
+  open(filename);
+}
+
+FileMap::~FileMap() {
+  close();
+}
+
+bool FileMap::isOpen() const {
+  return _data!=(const char*)0;
+}
+
+const char* FileMap::getData() const {
+  return _data;
+}
+
+size_t FileMap::getSize() const {
+  return _size;
+}
+
+#ifdef _WIN32
+
+bool FileMap::open(const char* filename) {
+  close();
+  if(filename==(const char*)0) return false;
+  HANDLE file = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,
+                            OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+  if(file==INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if(GetFileSizeEx(file,&size)==0) { CloseHandle(file); return false; }
+  if(size.QuadPart==0) {
+    CloseHandle(file);
+    _data = _empty;
+    return true;
+  }
+  HANDLE mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+  if(mapping==NULL) { CloseHandle(file); return false; }
+  void* data = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+  if(data==NULL) { CloseHandle(mapping); CloseHandle(file); return false; }
+  _handle  = (void*)file;
+  _mapping = (void*)mapping;
+  _data    = (const char*)data;
+  _size    = (size_t)size.QuadPart;
+  return true;
+}
+
+void FileMap::close() {
+  if(_data!=(const char*)0 && _data!=_empty)
+    UnmapViewOfFile((LPCVOID)_data);
+  if(_mapping!=(void*)0) CloseHandle((HANDLE)_mapping);
+  if(_handle !=(void*)0) CloseHandle((HANDLE)_handle);
+  _data    = (const char*)0;
+  _size    = 0;
+  _handle  = (void*)0;
+  _mapping = (void*)0;
+}
+
+#else /* POSIX */
+
+bool FileMap::open(const char* filename) {
+  close();
+  if(filename==(const char*)0) return false;
+  int fd = ::open(filename,O_RDONLY);
+  if(fd<0) return false;
+  struct stat st;
+  if(fstat(fd,&st)!=0 || S_ISREG(st.st_mode)==0) { ::close(fd); return false; }
+  if(st.st_size==0) {
+    ::close(fd);
+    _data = _empty;
+    return true;
+  }
+  void* data = mmap((void*)0,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  // the mapping stays valid after the file descriptor is closed
+  ::close(fd);
+  if(data==MAP_FAILED) return false;
+  // the loaders read the file front to back
+  madvise(data,(size_t)st.st_size,MADV_SEQUENTIAL);
+  _data = (const char*)data;
+  _size = (size_t)st.st_size;
+  return true;
+}
+
+void FileMap::close() {
+  if(_data!=(const char*)0 && _data!=_empty)
+    munmap((void*)_data,_size);
+  _data = (const char*)0;
+  _size = 0;
+}
+
+#endif /* _WIN32 */
@@ -35,6 +35,7 @@
 #ifndef _Loader_hpp_
 #define _Loader_hpp_
 
+#include <stddef.h>
 #include <wrl/SceneGraph.hpp>
 
 class Loader {
@@ -44,6 +45,14 @@ public:
   virtual bool  load(const char* filename, SceneGraph& wrl) = 0;
   virtual const char* ext() const = 0;
 
+  // Meshes whose coordIndex array would have more than
+  // getWideIndexThreshold() entries are loaded into the 64 bit
+  // coordIndex64 array of the IndexedFaceSet. The default is
+  // INT_MAX, the largest array which 32 bit indices can address;
+  // lower values are only useful to test the 64 bit path.
+  static size_t getWideIndexThreshold();
+  static void   setWideIndexThreshold(const size_t nCorners);
+
 };
 
 #endif // _Loader_hpp_
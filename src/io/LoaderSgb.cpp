@@ -0,0 +1,315 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// LoaderSgb.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+
+#include "LoaderSgb.hpp"
+#include "SgbFormat.hpp"
+#include "FileMap.hpp"
+#include "StrException.hpp"
+
+#include "wrl/Transform.hpp"
+#include "wrl/Shape.hpp"
+#include "wrl/Appearance.hpp"
+#include "wrl/Material.hpp"
+#include "wrl/ImageTexture.hpp"
+#include "wrl/IndexedFaceSet.hpp"
+#include "wrl/IndexedLineSet.hpp"
+
+using namespace std;
+
+const char* LoaderSgb::_ext = "sgb";
+
+// Decodes the node stream; every read is checked against the end of
+// the stream, and every array against the end of the array data.
+
+class _SgbReader {
+public:
+  const char* file;
+  const char* pos;
+  const char* end;
+  uint64_t    arrayEnd;
+public:
+  _SgbReader(const char* f, const uint64_t nodesOffset, const uint64_t nodesSize):
+    file(f), pos(f+nodesOffset), end(f+nodesOffset+nodesSize),
+    arrayEnd(nodesOffset) { }
+  void get(void* data, const size_t n) {
+    if((size_t)(end-pos)<n) throw new StrException("truncated node stream");
+    memcpy(data,pos,n);
+    pos += n;
+  }
+  uint32_t getUInt() { uint32_t u; get(&u,sizeof(u)); return u; }
+  uint64_t getUInt64() { uint64_t u; get(&u,sizeof(u)); return u; }
+  bool     getBool() { return getUInt()!=0u; }
+  float    getFloat() { float f; get(&f,sizeof(f)); return f; }
+  void     getVec3f(Vec3f& v) { v.x = getFloat(); v.y = getFloat(); v.z = getFloat(); }
+  void     getVec4f(Vec4f& v) {
+    v.x = getFloat(); v.y = getFloat(); v.z = getFloat(); v.w = getFloat();
+  }
+  void     getColor(Color& c) { c.r = getFloat(); c.g = getFloat(); c.b = getFloat(); }
+  void     getString(string& s) {
+    uint32_t n = getUInt();
+    if((size_t)(end-pos)<n) throw new StrException("truncated node stream");
+    s.assign(pos,n);
+    pos += n;
+  }
+  template <class T> void getArray(vector<T>& vec) {
+    uint64_t offset = getUInt64();
+    uint64_t n      = getUInt64();
+    if(n==0) {
+      vec.clear();
+      return;
+    }
+    if(offset<SGB_HEADER_SIZE || offset%SGB_ALIGNMENT!=0 ||
+       offset>arrayEnd || n>(arrayEnd-offset)/sizeof(T))
+      throw new StrException("invalid array");
+    const T* data = (const T*)(file+offset);
+    vec.assign(data,data+n);
+  }
+};
+
+static Node* _newNode(const uint32_t type) {
+  switch(type) {
+  case SGB_GROUP:            return new Group();
+  case SGB_TRANSFORM:        return new Transform();
+  case SGB_SHAPE:            return new Shape();
+  case SGB_APPEARANCE:       return new Appearance();
+  case SGB_MATERIAL:         return new Material();
+  case SGB_PIXEL_TEXTURE:    return new PixelTexture();
+  case SGB_IMAGE_TEXTURE:    return new ImageTexture();
+  case SGB_INDEXED_FACE_SET:
+  case SGB_INDEXED_FACE_SET_64:
+                             return new IndexedFaceSet();
+  case SGB_INDEXED_LINE_SET: return new IndexedLineSet();
+  default: break;
+  }
+  throw new StrException("unknown node type");
+}
+
+// new nodes are attached to their parents before their fields are
+// loaded, so that they are deleted with the scene graph on errors
+
+static void _loadNode(_SgbReader& r, Node* node, const uint32_t type);
+
+static void _loadGroup(_SgbReader& r, Group* group) {
+  Vec3f v;
+  r.getVec3f(v); group->setBBoxCenter(v);
+  r.getVec3f(v); group->setBBoxSize(v);
+  uint32_t nChildren = r.getUInt();
+  for(uint32_t i=0;i<nChildren;i++) {
+    uint32_t type = r.getUInt();
+    if(type==SGB_NULL) continue;
+    if(type!=SGB_GROUP && type!=SGB_TRANSFORM && type!=SGB_SHAPE)
+      throw new StrException("unexpected child node type");
+    Node* child = _newNode(type);
+    group->addChild(child);
+    _loadNode(r,child,type);
+  }
+}
+
+static void _loadNode(_SgbReader& r, Node* node, const uint32_t type) {
+  string name;
+  r.getString(name);
+  node->setName(name);
+  uint32_t t;
+  Vec3f    v;
+  Vec4f    q;
+  Color    c;
+  switch(type) {
+  case SGB_GROUP:
+    _loadGroup(r,(Group*)node);
+    break;
+  case SGB_TRANSFORM: {
+    Transform* transform = (Transform*)node;
+    _loadGroup(r,transform);
+    r.getVec3f(v); transform->setCenter(v);
+    r.getVec4f(q); transform->setRotation(q);
+    r.getVec3f(v); transform->setScale(v);
+    r.getVec4f(q); transform->setScaleOrientation(q);
+    r.getVec3f(v); transform->setTranslation(v);
+  } break;
+  case SGB_SHAPE: {
+    Shape* shape = (Shape*)node;
+    if((t=r.getUInt())!=SGB_NULL) {
+      if(t!=SGB_APPEARANCE)
+        throw new StrException("unexpected appearance node type");
+      Node* appearance = _newNode(t);
+      shape->setAppearance(appearance);
+      _loadNode(r,appearance,t);
+    }
+    if((t=r.getUInt())!=SGB_NULL) {
+      if(t!=SGB_INDEXED_FACE_SET && t!=SGB_INDEXED_FACE_SET_64 &&
+         t!=SGB_INDEXED_LINE_SET)
+        throw new StrException("unexpected geometry node type");
+      Node* geometry = _newNode(t);
+      shape->setGeometry(geometry);
+      _loadNode(r,geometry,t);
+    }
+  } break;
+  case SGB_APPEARANCE: {
+    Appearance* appearance = (Appearance*)node;
+    if((t=r.getUInt())!=SGB_NULL) {
+      if(t!=SGB_MATERIAL)
+        throw new StrException("unexpected material node type");
+      Node* material = _newNode(t);
+      appearance->setMaterial(material);
+      _loadNode(r,material,t);
+    }
+    if((t=r.getUInt())!=SGB_NULL) {
+      if(t!=SGB_PIXEL_TEXTURE && t!=SGB_IMAGE_TEXTURE)
+        throw new StrException("unexpected texture node type");
+      Node* texture = _newNode(t);
+      appearance->setTexture(texture);
+      _loadNode(r,texture,t);
+    }
+  } break;
+  case SGB_MATERIAL: {
+    Material* material = (Material*)node;
+    material->setAmbientIntensity(r.getFloat());
+    r.getColor(c); material->setDiffuseColor(c);
+    r.getColor(c); material->setEmissiveColor(c);
+    material->setShininess(r.getFloat());
+    r.getColor(c); material->setSpecularColor(c);
+    material->setTransparency(r.getFloat());
+  } break;
+  case SGB_PIXEL_TEXTURE:
+  case SGB_IMAGE_TEXTURE: {
+    PixelTexture* pixelTexture = (PixelTexture*)node;
+    pixelTexture->setRepeatS(r.getBool());
+    pixelTexture->setRepeatT(r.getBool());
+    if(type==SGB_IMAGE_TEXTURE) {
+      ImageTexture* imageTexture = (ImageTexture*)node;
+      uint32_t nUrl = r.getUInt();
+      for(uint32_t i=0;i<nUrl;i++) {
+        string url;
+        r.getString(url);
+        imageTexture->adToUrl(url);
+      }
+    }
+  } break;
+  case SGB_INDEXED_FACE_SET:
+  case SGB_INDEXED_FACE_SET_64: {
+    IndexedFaceSet& ifs = *((IndexedFaceSet*)node);
+    ifs.getCcw()             = r.getBool();
+    ifs.getConvex()          = r.getBool();
+    ifs.getSolid()           = r.getBool();
+    ifs.getCreaseangle()     = r.getFloat();
+    ifs.getNormalPerVertex() = r.getBool();
+    ifs.getColorPerVertex()  = r.getBool();
+    r.getArray(ifs.getCoord());
+    if(type==SGB_INDEXED_FACE_SET_64)
+      r.getArray(ifs.getCoordIndex64());
+    else
+      r.getArray(ifs.getCoordIndex());
+    r.getArray(ifs.getNormal());
+    r.getArray(ifs.getNormalIndex());
+    r.getArray(ifs.getColor());
+    r.getArray(ifs.getColorIndex());
+    r.getArray(ifs.getTexCoord());
+    r.getArray(ifs.getTexCoordIndex());
+  } break;
+  case SGB_INDEXED_LINE_SET: {
+    IndexedLineSet& ils = *((IndexedLineSet*)node);
+    ils.getColorPerVertex()  = r.getBool();
+    r.getArray(ils.getCoord());
+    r.getArray(ils.getCoordIndex());
+    r.getArray(ils.getColor());
+    r.getArray(ils.getColorIndex());
+  } break;
+  default:
+    throw new StrException("unknown node type");
+  }
+}
+
+bool LoaderSgb::load(const char* filename, SceneGraph& wrl) {
+  bool success = false;
+
+  try {
+
+    // map the file
+    if(filename==(char*)0) throw new StrException("filename==null");
+    FileMap map(filename);
+    if(map.isOpen()==false) throw new StrException("unable to map file");
+
+    // clear the container
+    wrl.clear();
+    wrl.setUrl(filename);
+
+    // read and check the header
+    const char* file = map.getData();
+    uint64_t    size = (uint64_t)map.getSize();
+    if(size<SGB_HEADER_SIZE || memcmp(file,SGB_MAGIC,strlen(SGB_MAGIC)+1)!=0)
+      throw new StrException("not a SGB file");
+    uint32_t version, byteOrder;
+    uint64_t nodesOffset, nodesSize, fileSize;
+    memcpy(&version,    file+ 8,4);
+    memcpy(&byteOrder,  file+12,4);
+    memcpy(&nodesOffset,file+16,8);
+    memcpy(&nodesSize,  file+24,8);
+    memcpy(&fileSize,   file+32,8);
+    if(version!=SGB_VERSION)
+      throw new StrException("unsupported SGB version");
+    if(byteOrder!=SGB_BYTE_ORDER)
+      throw new StrException("SGB file written with a different byte order");
+    if(fileSize!=size || nodesOffset<SGB_HEADER_SIZE ||
+       nodesOffset>size || nodesSize>size-nodesOffset)
+      throw new StrException("corrupted SGB file");
+
+    // the SceneGraph is stored as a Group
+    _SgbReader r(file,nodesOffset,nodesSize);
+    if(r.getUInt()!=SGB_GROUP)
+      throw new StrException("expecting SceneGraph");
+    string name;
+    r.getString(name);
+    wrl.setName(name);
+    _loadGroup(r,&wrl);
+
+    // if we have reached this point we have succeeded
+    success = true;
+
+  } catch(StrException* e) { 
+
+    fprintf(stderr,"ERROR | %s\n",e->what());
+    delete e;
+    wrl.clear();
+    wrl.setUrl("");
+
+  }
+
+  return success;
+}
@@ -40,8 +40,11 @@
 #include <vector>
 #include <string>
 #include <math.h>
+#include <limits.h>
+#include <string_view>
 
-#include "TokenizerFile.hpp"
+#include "FileMap.hpp"
+#include "TokenizerMmap.hpp"
 #include "LoaderStl.hpp"
 #include "StrException.hpp"
 
@@ -50,6 +53,9 @@
 #include "wrl/Material.hpp"
 #include "wrl/IndexedFaceSet.hpp"
 
+#include "util/Parallel.hpp"
+#include "util/VertexWelder.hpp"
+
 using namespace std;
 
 // reference
@@ -57,6 +63,146 @@ using namespace std;
 
 const char* LoaderStl::_ext = "stl";
 
+// ASCII files are split into chunks, which are parsed in parallel.
+// A chunk may only start at a "facet" token which follows an
+// "endfacet" token found at the beginning of a line, so that each
+// chunk is parsed exactly as it would be as part of the whole file.
+
+static bool _isBlank(const char c) {
+  return (c==' ' || c=='\t' || c=='\n' || c=='\r' || c==',');
+}
+
+static bool _isToken
+(const char* p, const char* begin, const char* end, const char* str) {
+  size_t n = strlen(str);
+  if(p>begin && !_isBlank(p[-1])) return false;
+  if((size_t)(end-p)<n || strncmp(p,str,n)!=0) return false;
+  return (p+n==end || _isBlank(p[n]));
+}
+
+// returns the beginning of the first chunk starting at or after pos
+static const char* _nextChunk
+(const char* begin, const char* end, const char* pos) {
+  string_view text(begin,(size_t)(end-begin));
+  size_t i = (size_t)(pos-begin);
+  while((i=text.find("endfacet",i))!=string_view::npos) {
+    const char* p = begin+i;
+    i += 8;
+    const char* t = p;
+    while(t>begin && t[-1]!='\n' && _isBlank(t[-1])) t--;
+    if(t>begin && t[-1]!='\n') continue;
+    if(_isToken(p,begin,end,"endfacet")==false) continue;
+    for(p+=8;p<end && _isBlank(*p);p++);
+    if(_isToken(p,begin,end,"facet")) return p;
+  }
+  return end;
+}
+
+static void _facetNormal(const float* c /*[9]*/, float* n /*[3]*/) {
+  // Cross Product
+  // get 3 vertices P1, P2, P3
+  const float* p1 = c;
+  const float* p2 = c+3;
+  const float* p3 = c+6;
+
+  // calculate two vectors U = P2 - P1, V = P3 - P1
+  float u[3] = {p2[0]-p1[0], p2[1]-p1[1], p2[2]-p1[2]};
+  float v[3] = {p3[0]-p1[0], p3[1]-p1[1], p3[2]-p1[2]};
+
+  // calculate cross Product, get N
+  float nx = u[1]*v[2] - u[2]*v[1];
+  float ny = u[2]*v[0] - u[0]*v[2];
+  float nz = u[0]*v[1] - u[1]*v[0];
+
+  // Normalize
+  float len = sqrt(nx*nx + ny*ny + nz*nz);
+  if (len > 0.000001f) {
+    nx /= len; ny /= len; nz /= len;
+  } else {
+    // if get it is too small, give a default value
+    nx = 0; ny = 0; nz = 1;
+  }
+  n[0] = nx; n[1] = ny; n[2] = nz;
+}
+
+// parses the facets contained in [begin,end); facets which do not
+// have exactly three vertices are ignored
+static void _loadAsciiChunk
+(const char* begin, const char* end,
+ vector<float>& coord, vector<float>& normal) {
+  TokenizerMmap tkn(begin,end);
+  float c[9], n[3];
+  while (tkn.get()) {
+    if (tkn.equals("facet")) {
+      int nCoords = 0;
+      while (tkn.get()) {
+        if (tkn.equals("vertex")) {
+          float x=0, y=0, z=0;
+          if(tkn.get()) tkn.toFloat(x);
+          if(tkn.get()) tkn.toFloat(y);
+          if(tkn.get()) tkn.toFloat(z);
+          if(nCoords<9) {
+            c[nCoords] = x; c[nCoords+1] = y; c[nCoords+2] = z;
+          }
+          nCoords += 3;
+        }
+        else if (tkn.equals("endfacet") || tkn.equals("endsolid")) {
+          break;
+        }
+      }
+      if (nCoords == 9) {
+        _facetNormal(c,n);
+        normal.insert(normal.end(),n,n+3);
+        coord.insert(coord.end(),c,c+9);
+      }
+    }
+  }
+}
+
+// fills the coordIndex entries of the unwelded triangles t0<=t<t1,
+// whose vertices are 3t, 3t+1 and 3t+2
+template <class Index>
+static void _setTriangles(Index* ci, const size_t t0, const size_t t1) {
+  for (size_t t = t0; t < t1; t++) {
+    *ci++ = (Index)(3*t);
+    *ci++ = (Index)(3*t+1);
+    *ci++ = (Index)(3*t+2);
+    *ci++ = -1;
+  }
+}
+
+// the welder uses 32 bit vertex indices, even if the coordIndex
+// array does not
+static void _checkWeldSize(const VertexWelder& welder) {
+  if (welder.getNumberOfVertices() > (size_t)(INT_MAX-3))
+    throw new StrException("too many vertices to weld");
+}
+
+// prints the number of vertices before and after welding, and the
+// memory used by the loaded arrays; the peak is not measured, but
+// estimated as an upper bound, the sum of the unwelded per-chunk
+// buffers of the ASCII reader, the hash table, and the capacities of
+// the final arrays, as if none of them were released while welding
+template <class Index>
+static void _weldReport
+(const VertexWelder& welder, const size_t inputBytes, const size_t nFacets,
+ const vector<float>& coord, const vector<float>& normal,
+ const vector<Index>& coordIndex) {
+  const double MB = 1024.0*1024.0;
+  size_t bytes = (coord.size()+normal.size())*sizeof(float)+coordIndex.size()*sizeof(Index);
+  size_t unwelded = 16*nFacets*sizeof(float);
+  size_t peakBound =
+    inputBytes+welder.getMemorySize()+
+    (coord.capacity()+normal.capacity())*sizeof(float)+
+    coordIndex.capacity()*sizeof(Index);
+  fprintf(stdout, "Welding = %zu -> %zu vertices (epsilon = %g)\n",
+          welder.getNumberOfAdded(), welder.getNumberOfVertices(),
+          (double)welder.getEpsilon());
+  fprintf(stdout, "Memory = %.2f MB (%.2f MB without welding), "
+          "peak %.2f MB (estimated upper bound)\n",
+          bytes/MB, unwelded/MB, peakBound/MB);
+}
+
 bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
   bool success = false;
 
@@ -64,28 +210,22 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
   wrl.clear();
   wrl.setUrl("");
 
-  FILE* fp = (FILE*)0;
   fprintf(stdout, "Starting LoaderStl::load for %s\n", filename);
   try {
-      int facetCount = 0;
+      size_t facetCount = 0;
 
     // open the file
     if(filename==(char*)0) throw new StrException("filename==null");
 
-    //use binary mode, so that can read it
-    fp = fopen(filename, "rb");
-    if(fp==(FILE*)0) throw new StrException("fp==(FILE*)0");
-
-    //calcutale the size of files
-    fseek(fp, 0, SEEK_END);
-    long fileSize = ftell(fp);
-    rewind(fp);
+    // map the whole file, which is read in place by both branches
+    FileMap map(filename);
+    if(map.isOpen()==false) throw new StrException("unable to map file");
+    const char* begin = map.getData();
+    const char* end   = begin+map.getSize();
 
+    long fileSize = (long)map.getSize();
     fprintf(stdout, "File Size = %ld bytes\n", fileSize);
 
-
-
-
       // TODO ...
 
       // create the scene graph structure :
@@ -106,8 +246,10 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
       IndexedFaceSet* ifs = new IndexedFaceSet();
       shape->setGeometry(ifs);
 
-      // 5) get references to the coordIndex, coord, and normal arrays
-      vector<int>& coordIndex = ifs->getCoordIndex();
+      // 5) get references to the coord, and normal arrays; the
+      // faces are stored in the coordIndex array, or in the
+      // coordIndex64 array if the mesh is too large for 32 bit
+      // indices
       vector<float>& coord = ifs->getCoord();
       vector<float>& normal = ifs->getNormal();
 
@@ -129,18 +271,15 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
       bool isBinary = false;
       unsigned int numTriangles = 0;
       if (fileSize >= 84) {
-          char header[80];
-          if (fread(header, 1, 80, fp) == 80) {
-              fread(&numTriangles, 4, 1, fp);
-              //calculate the size of file, must match
-              // 80 bytes header + 4 bytes count + 50 bytes per triangle
-              long headerSize = 80;
-              long countSize = 4;
-              long triangleSize = 50;
-              long expectedSize = headerSize + countSize + (numTriangles * triangleSize);
-              if (fileSize == expectedSize) {
-                  isBinary = true;
-              }
+          memcpy(&numTriangles, begin+80, 4);
+          //calculate the size of file, must match
+          // 80 bytes header + 4 bytes count + 50 bytes per triangle
+          long headerSize = 80;
+          long countSize = 4;
+          long triangleSize = 50;
+          long expectedSize = headerSize + countSize + (numTriangles * triangleSize);
+          if (fileSize == expectedSize) {
+              isBinary = true;
           }
       }
 
@@ -149,34 +288,60 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
       // ==========================================
       if (isBinary) {
           fprintf(stdout, "Format Detected = BINARY (Matches size formula)\n");
-          facetCount = (int)numTriangles;
-          int vertexCount = 0;
-
-          float n[3], v1[3], v2[3], v3[3];
-          // attribute byte count, unused but must read
-          unsigned short attr;
-
-          // must get back to the beginning
-          fseek(fp, 84, SEEK_SET);
-
-          for (unsigned int i = 0; i < numTriangles; i++) {
-              if(fread(n, 4, 3, fp) != 3) break;
-              if(fread(v1, 4, 3, fp) != 3) break;
-              if(fread(v2, 4, 3, fp) != 3) break;
-              if(fread(v3, 4, 3, fp) != 3) break;
-              fread(&attr, 2, 1, fp);
-
-              normal.push_back(n[0]); normal.push_back(n[1]); normal.push_back(n[2]);
-
-              coord.push_back(v1[0]); coord.push_back(v1[1]); coord.push_back(v1[2]);
-              coord.push_back(v2[0]); coord.push_back(v2[1]); coord.push_back(v2[2]);
-              coord.push_back(v3[0]); coord.push_back(v3[1]); coord.push_back(v3[2]);
-
-              coordIndex.push_back(vertexCount);
-              coordIndex.push_back(vertexCount+1);
-              coordIndex.push_back(vertexCount+2);
-              coordIndex.push_back(-1);
-              vertexCount += 3;
+          facetCount = (size_t)numTriangles;
+          size_t nT = (size_t)numTriangles;
+          bool wide = (4*nT > getWideIndexThreshold());
+          if (wide)
+              fprintf(stdout, "Index Size = 64 bit (%zu corners)\n", 4*nT);
+
+          // each record is made of the normal, the three vertices, and
+          // an unused 2 byte attribute; the records are not aligned, so
+          // the fields are copied with fixed size memcpy calls, which
+          // compile to unaligned loads and stores
+          const char* record = begin+84;
+          if (_weld) {
+              // merge the vertices as the records are read, so that
+              // the unwelded coord array is never allocated
+              auto weld = [&](auto& coordIndex) {
+                  VertexWelder welder(coord,_weldEpsilon,nT/2);
+                  normal.resize(3*nT);
+                  coordIndex.resize(4*nT);
+                  const char* r = record;
+                  float* n = normal.data();
+                  auto* ci = coordIndex.data();
+                  float v[9];
+                  for (size_t t = 0; t < nT; t++, r += 50, n += 3) {
+                      if (wide) _checkWeldSize(welder);
+                      memcpy(n, r, 12);
+                      memcpy(v, r+12, 36);
+                      *ci++ = welder.add(v);
+                      *ci++ = welder.add(v+3);
+                      *ci++ = welder.add(v+6);
+                      *ci++ = -1;
+                  }
+                  _weldReport(welder, 0, nT, coord, normal, coordIndex);
+              };
+              if (wide) weld(ifs->getCoordIndex64());
+              else      weld(ifs->getCoordIndex());
+          } else {
+              normal.resize(3*nT);
+              coord.resize(9*nT);
+              if (wide) ifs->getCoordIndex64().resize(4*nT);
+              else      ifs->getCoordIndex().resize(4*nT);
+              // blocks of at least 2^16 triangles
+              size_t grain = Parallel::getGrain(nT, 0);
+              if (grain < (1<<16)) grain = 1<<16;
+              Parallel::forRange(nT, grain, [&](size_t t0, size_t t1) {
+                  const char* r = record+50*t0;
+                  float* n = normal.data()+3*t0;
+                  float* v = coord.data()+9*t0;
+                  for (size_t t = t0; t < t1; t++, r += 50, n += 3, v += 9) {
+                      memcpy(n, r, 12);
+                      memcpy(v, r+12, 36);
+                  }
+                  if (wide) _setTriangles(ifs->getCoordIndex64().data()+4*t0, t0, t1);
+                  else      _setTriangles(ifs->getCoordIndex().data()+4*t0, t0, t1);
+              });
           }
           success = true;
       }
@@ -186,93 +351,90 @@ bool LoaderStl::load(const char* filename, SceneGraph& wrl) {
       else {
           fprintf(stdout, "Format Detected = ASCII (Safe-Block + Auto-Normal)\n");
 
-          rewind(fp);
-          TokenizerFile tkn(fp);
-
-          int vertexCount = 0;
-
-          while (tkn.get()) {
-              string token = tkn;
-
-              if (token == "facet") {
-                  vector<float> tempCoords;
-
-                  while (tkn.get()) {
-                      string subToken = tkn;
-
-                      if (subToken == "vertex") {
-                          float x=0, y=0, z=0;
-                          if(tkn.get()) x = (float)atof(string(tkn).c_str());
-                          if(tkn.get()) y = (float)atof(string(tkn).c_str());
-                          if(tkn.get()) z = (float)atof(string(tkn).c_str());
-                          tempCoords.push_back(x);
-                          tempCoords.push_back(y);
-                          tempCoords.push_back(z);
-                      }
-                      else if (subToken == "endfacet" || subToken == "endsolid") {
-                          break;
+          // split the file into the blocks of Parallel::forRange(),
+          // if they are at least 1MB each
+          size_t step = Parallel::getGrain(map.getSize(), 0);
+          if (step < (1<<20)) step = map.getSize();
+          vector<const char*> cut;
+          cut.push_back(begin);
+          while (cut.back() < end) {
+              const char* pos = end;
+              if (step < (size_t)(end-cut.back())) pos = cut.back()+step;
+              cut.push_back(_nextChunk(begin,end,pos));
+          }
+          size_t nChunks = cut.size()-1;
+
+          vector<vector<float> > chunkCoord(nChunks);
+          vector<vector<float> > chunkNormal(nChunks);
+          Parallel::forEach(nChunks, [&](size_t i) {
+              _loadAsciiChunk(cut[i],cut[i+1],chunkCoord[i],chunkNormal[i]);
+          });
+
+          // concatenate the chunks
+          vector<size_t> first(nChunks+1,0);
+          for (size_t i = 0; i < nChunks; i++)
+              first[i+1] = first[i]+chunkNormal[i].size()/3;
+          size_t nFacets = first[nChunks];
+          facetCount = nFacets;
+          bool wide = (4*nFacets > getWideIndexThreshold());
+          if (wide)
+              fprintf(stdout, "Index Size = 64 bit (%zu corners)\n", 4*nFacets);
+          if (_weld) {
+              size_t chunkBytes = 12*nFacets*sizeof(float);
+              auto weld = [&](auto& coordIndex) {
+                  VertexWelder welder(coord,_weldEpsilon,nFacets/2);
+                  normal.resize(3*nFacets);
+                  coordIndex.resize(4*nFacets);
+                  auto* ci = coordIndex.data();
+                  for (size_t i = 0; i < nChunks; i++) {
+                      size_t nF = first[i+1]-first[i];
+                      if (nF > 0)
+                          memcpy(&normal[3*first[i]],chunkNormal[i].data(),3*nF*sizeof(float));
+                      const float* v = chunkCoord[i].data();
+                      for (size_t f = 0; f < nF; f++, v += 9) {
+                          if (wide) _checkWeldSize(welder);
+                          *ci++ = welder.add(v);
+                          *ci++ = welder.add(v+3);
+                          *ci++ = welder.add(v+6);
+                          *ci++ = -1;
                       }
+                      vector<float>().swap(chunkCoord[i]);
+                      vector<float>().swap(chunkNormal[i]);
                   }
-
-                  if (tempCoords.size() == 9) {
-                      facetCount++;
-
-                      // Cross Product
-                      // get 3 vertices P1, P2, P3
-                      float p1[3] = {tempCoords[0], tempCoords[1], tempCoords[2]};
-                      float p2[3] = {tempCoords[3], tempCoords[4], tempCoords[5]};
-                      float p3[3] = {tempCoords[6], tempCoords[7], tempCoords[8]};
-
-                      // calculate two vectors U = P2 - P1, V = P3 - P1
-                      float u[3] = {p2[0]-p1[0], p2[1]-p1[1], p2[2]-p1[2]};
-                      float v[3] = {p3[0]-p1[0], p3[1]-p1[1], p3[2]-p1[2]};
-
-                      // calculate cross Product, get N
-                      float nx = u[1]*v[2] - u[2]*v[1];
-                      float ny = u[2]*v[0] - u[0]*v[2];
-                      float nz = u[0]*v[1] - u[1]*v[0];
-
-                      // Normalize
-                      float len = sqrt(nx*nx + ny*ny + nz*nz);
-                      if (len > 0.000001f) {
-                          nx /= len; ny /= len; nz /= len;
-                      } else {
-                          // if get it is too small, give a default value
-                          nx = 0; ny = 0; nz = 1;
-                      }
-
-
-
-                      normal.push_back(nx);
-                      normal.push_back(ny);
-                      normal.push_back(nz);
-
-
-                      for (size_t k = 0; k < 9; k++) coord.push_back(tempCoords[k]);
-
-                      coordIndex.push_back(vertexCount);
-                      coordIndex.push_back(vertexCount+1);
-                      coordIndex.push_back(vertexCount+2);
-                      coordIndex.push_back(-1);
-                      vertexCount += 3;
+                  _weldReport(welder, chunkBytes, nFacets, coord, normal, coordIndex);
+              };
+              if (wide) weld(ifs->getCoordIndex64());
+              else      weld(ifs->getCoordIndex());
+          } else {
+              coord.resize(9*nFacets);
+              normal.resize(3*nFacets);
+              if (wide) ifs->getCoordIndex64().resize(4*nFacets);
+              else      ifs->getCoordIndex().resize(4*nFacets);
+              Parallel::forEach(nChunks, [&](size_t i) {
+                  size_t f0 = first[i];
+                  size_t nF = first[i+1]-f0;
+                  if (nF > 0) {
+                      memcpy(&coord[9*f0],chunkCoord[i].data(),9*nF*sizeof(float));
+                      memcpy(&normal[3*f0],chunkNormal[i].data(),3*nF*sizeof(float));
                   }
-              }
+                  vector<float>().swap(chunkCoord[i]);
+                  vector<float>().swap(chunkNormal[i]);
+                  if (wide) _setTriangles(ifs->getCoordIndex64().data()+4*f0, f0, f0+nF);
+                  else      _setTriangles(ifs->getCoordIndex().data()+4*f0, f0, f0+nF);
+              });
           }
 
           if (facetCount > 0) success = true;
       }
 
-      fclose(fp);
-
       /*
       if (success)
-          fprintf(stderr, "DEBUG: Load Finished. Total facets loaded: %d\n", facetCount);
+          fprintf(stderr, "DEBUG: Load Finished. Total facets loaded: %zu\n", facetCount);
       else
           fprintf(stderr, "WARNING: Load failed (0 facets read).\n");
 */
 
   } catch(StrException* e) {
-      if(fp!=(FILE*)0) fclose(fp);
       fprintf(stderr,"CRITICAL ERROR | %s\n", e->what());
       delete e;
       success = false;
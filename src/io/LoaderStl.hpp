@@ -48,14 +48,28 @@ private:
 
   const static char* _ext;
 
+  bool  _weld;
+  float _weldEpsilon;
+
 public:
 
-  LoaderStl()  {};
+  LoaderStl(): _weld(false), _weldEpsilon(0.0f) {};
   ~LoaderStl() {};
 
   bool  load(const char* filename, SceneGraph& wrl);
   const char* ext() const { return _ext; }
 
+  // By default every triangle gets three new vertices. If welding is
+  // enabled, coincident vertices are merged while the triangles are
+  // loaded, and the coord array only contains distinct vertices. If
+  // the epsilon is 0, vertices with identical coordinates are merged;
+  // otherwise vertices within distance epsilon of each other are
+  // merged. See util/VertexWelder.hpp for details.
+  void  setWeld(const bool value) { _weld = value; }
+  bool  getWeld() const { return _weld; }
+  void  setWeldEpsilon(const float value) { _weldEpsilon = value; }
+  float getWeldEpsilon() const { return _weldEpsilon; }
+
 };
 
 #endif /* _LOADER_STL_HPP_ */
@@ -33,7 +33,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdio.h>
-#include "TokenizerFile.hpp"
+#include <string.h>
 #include "LoaderWrl.hpp"
 #include "StrException.hpp"
 
@@ -41,7 +41,7 @@
 
 const char* LoaderWrl::_ext = "wrl";
 
-bool LoaderWrl::loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl) {
+bool LoaderWrl::loadSceneGraph(TokenizerMmap& tkn, SceneGraph& wrl) {
 
   string name    = "";
   bool   success = false;
@@ -49,7 +49,7 @@ bool LoaderWrl::loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl) {
     if(tkn.equals("DEF")) {
       // if(name!="") throw StrException("DEF name DEF");
       tkn.get("missing token after DEF");
-      name = tkn;
+      name = tkn.str();
     } else if(tkn.equals("Group")) {
       Group* g = new Group();
       wrl.addChild(g);
@@ -71,7 +71,7 @@ bool LoaderWrl::loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl) {
     } else if(tkn.equals("")) {
       break;
     } else {
-      fprintf(stderr,"tkn=\"%s\"\n",tkn.c_str());
+      fprintf(stderr,"tkn=\"%s\"\n",tkn.str().c_str());
       throw new StrException("unexpected token while parsing Group");
     }
   }
@@ -79,7 +79,7 @@ bool LoaderWrl::loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl) {
   return success;
 }
 
-bool LoaderWrl::loadGroup(Tokenizer& tkn, Group& group) {
+bool LoaderWrl::loadGroup(TokenizerMmap& tkn, Group& group) {
 
   // Group {
   //   MFNode children    []
@@ -111,7 +111,7 @@ bool LoaderWrl::loadGroup(Tokenizer& tkn, Group& group) {
   return success;
 }
 
-bool LoaderWrl::loadTransform(Tokenizer& tkn, Transform& transform) {
+bool LoaderWrl::loadTransform(TokenizerMmap& tkn, Transform& transform) {
 
   // Transform {
   //   MFNode     children          []
@@ -175,14 +175,14 @@ bool LoaderWrl::loadTransform(Tokenizer& tkn, Transform& transform) {
   return success;
 }
 
-bool LoaderWrl::loadChildren(Tokenizer& tkn, Group& group) {
+bool LoaderWrl::loadChildren(TokenizerMmap& tkn, Group& group) {
   string name    = "";
   bool   success = false;
   if(tkn.expecting("[")==false) throw new StrException("expecting \"[\"");
   while(success==false && tkn.get()) {
     if(tkn.equals("DEF")) {
       tkn.get("missing token after DEF");
-      name = tkn;
+      name = tkn.str();
     } else if(tkn.equals("Group")) {
       Group* g = new Group();
       group.addChild(g);
@@ -210,7 +210,7 @@ bool LoaderWrl::loadChildren(Tokenizer& tkn, Group& group) {
   return success;
 }
 
-bool LoaderWrl::loadShape(Tokenizer& tkn, Shape& shape) {
+bool LoaderWrl::loadShape(TokenizerMmap& tkn, Shape& shape) {
 
   // Shape {
   //   SFNode appearance NULL
@@ -228,7 +228,7 @@ bool LoaderWrl::loadShape(Tokenizer& tkn, Shape& shape) {
       tkn.get("expecting appearance node");
       if(tkn.equals("DEF")) {
         tkn.get("missing token after DEF");
-        name = tkn;
+        name = tkn.str();
         tkn.get("missing Appearance token");
       }
       if(tkn.equals("Appearance")==false)
@@ -242,7 +242,7 @@ bool LoaderWrl::loadShape(Tokenizer& tkn, Shape& shape) {
       tkn.get("expecting geometry node");
       if(tkn.equals("DEF")) {
         tkn.get("missing token after DEF");
-        name = tkn;
+        name = tkn.str();
         tkn.get("missing Appearance token");
       }
       if(tkn.equals("IndexedFaceSet")) {
@@ -269,7 +269,7 @@ bool LoaderWrl::loadShape(Tokenizer& tkn, Shape& shape) {
   return success;
 }
 
-bool LoaderWrl::loadAppearance(Tokenizer& tkn, Appearance& appearance) {
+bool LoaderWrl::loadAppearance(TokenizerMmap& tkn, Appearance& appearance) {
 
   // Appearance {
   //   SFNode material NULL
@@ -288,7 +288,7 @@ bool LoaderWrl::loadAppearance(Tokenizer& tkn, Appearance& appearance) {
       tkn.get("expecting material node");
       if(tkn.equals("DEF")) {
         tkn.get("missing token after DEF");
-        name = tkn;
+        name = tkn.str();
         tkn.get("missing Appearance token");
       }
       if(tkn.equals("Material")==false)
@@ -302,7 +302,7 @@ bool LoaderWrl::loadAppearance(Tokenizer& tkn, Appearance& appearance) {
       tkn.get("expecting Texture node");
       if(tkn.equals("DEF")) {
         tkn.get("missing token after DEF");
-        name = tkn;
+        name = tkn.str();
         tkn.get("missing Appearance token");
       }
       if(tkn.equals("ImageTexture")) {
@@ -327,7 +327,7 @@ bool LoaderWrl::loadAppearance(Tokenizer& tkn, Appearance& appearance) {
   return success;
 }
 
-bool LoaderWrl::loadMaterial(Tokenizer& tkn, Material& material) {
+bool LoaderWrl::loadMaterial(TokenizerMmap& tkn, Material& material) {
 
   // Material {
   //   SFFloat ambientIntensity 0.2
@@ -381,7 +381,7 @@ bool LoaderWrl::loadMaterial(Tokenizer& tkn, Material& material) {
 
 }
 
-bool LoaderWrl::loadImageTexture(Tokenizer& tkn, ImageTexture& imageTexture) {
+bool LoaderWrl::loadImageTexture(TokenizerMmap& tkn, ImageTexture& imageTexture) {
 
   // ImageTexture {
   //   MFString url []
@@ -415,7 +415,7 @@ bool LoaderWrl::loadImageTexture(Tokenizer& tkn, ImageTexture& imageTexture) {
   return success;
 }
 
-bool LoaderWrl::loadIndexedFaceSet(Tokenizer& tkn, IndexedFaceSet& ifs) {
+bool LoaderWrl::loadIndexedFaceSet(TokenizerMmap& tkn, IndexedFaceSet& ifs) {
 
   // IndexedFaceSet {
   //   SFNode  color             NULL
@@ -527,8 +527,11 @@ bool LoaderWrl::loadIndexedFaceSet(Tokenizer& tkn, IndexedFaceSet& ifs) {
         throw new StrException("loading IndexedFaceSet convex field");
     } else if(tkn.equals("coordIndex")) {
       //   MFInt32 
-      vector<int>& _coordIndex = ifs.getCoordIndex();
-      if(loadVecInt(tkn,_coordIndex)==false)
+      //   arrays too large for 32 bit indices are loaded into the
+      //   64 bit coordIndex64 array
+      vector<int>&     _coordIndex   = ifs.getCoordIndex();
+      vector<int64_t>& _coordIndex64 = ifs.getCoordIndex64();
+      if(loadVecInt(tkn,_coordIndex,_coordIndex64)==false)
         throw new StrException("loading IndexedFaceSet coordIndex field");
     } else if(tkn.equals("creaseAngle")) {
       //   SFFloat
@@ -564,7 +567,7 @@ bool LoaderWrl::loadIndexedFaceSet(Tokenizer& tkn, IndexedFaceSet& ifs) {
   return success;
 }
 
-bool LoaderWrl::loadIndexedLineSet(Tokenizer& tkn, IndexedLineSet& ifs) {
+bool LoaderWrl::loadIndexedLineSet(TokenizerMmap& tkn, IndexedLineSet& ifs) {
 
   // IndexedFaceSet {
   //   SFNode  coord             NULL
@@ -635,40 +638,28 @@ bool LoaderWrl::loadIndexedLineSet(Tokenizer& tkn, IndexedLineSet& ifs) {
   return success;
 }
 
-bool LoaderWrl::loadVecFloat(Tokenizer&tkn,vector<float>& vec) {
-  bool success = false;
+bool LoaderWrl::loadVecFloat(TokenizerMmap& tkn,vector<float>& vec) {
   if(tkn.expecting("[")==false) throw new StrException("expecting \"[\"");
-  float value;
-  while(success==false && tkn.get()) {
-    if(tkn.equals("]")) {
-      success = true; // done
-    } else if(sscanf(tkn.c_str(),"%f",&value)==1) {
-      vec.push_back(value);
-    } else {
-      throw new StrException("expecting int value");
-    }
-  }
+  // bulk parse up to the matching "]", see TokenizerMmap::getVecFloat()
+  if(tkn.getVecFloat(vec)==false) throw new StrException("expecting float value");
+  return true;
+}
 
-  return success;
+bool LoaderWrl::loadVecInt(TokenizerMmap& tkn,vector<int>& vec) {
+  if(tkn.expecting("[")==false) throw new StrException("expecting \"[\"");
+  if(tkn.getVecInt(vec)==false) throw new StrException("expecting int value");
+  return true;
 }
 
-bool LoaderWrl::loadVecInt(Tokenizer&tkn,vector<int>& vec) {
-  bool success = false;
+bool LoaderWrl::loadVecInt
+(TokenizerMmap& tkn,vector<int>& vec,vector<int64_t>& vec64) {
   if(tkn.expecting("[")==false) throw new StrException("expecting \"[\"");
-  int value;
-  while(success==false && tkn.get()) {
-    if(tkn.equals("]")) {
-      success = true; // done
-    } else if(sscanf(tkn.c_str(),"%d",&value)==1) {
-      vec.push_back(value);
-    } else {
-      throw new StrException("expecting int value");
-    }
-  }
-  return success;
+  if(tkn.getVecInt(vec,vec64,getWideIndexThreshold())==false)
+    throw new StrException("expecting int value");
+  return true;
 }
 
-bool LoaderWrl::loadVecString(Tokenizer&tkn,vector<string>& vec) {
+bool LoaderWrl::loadVecString(TokenizerMmap& tkn,vector<string>& vec) {
   bool success = false;
   tkn.get("expecting a token");
   if(tkn.equals("[")) {
@@ -677,13 +668,13 @@ bool LoaderWrl::loadVecString(Tokenizer&tkn,vector<string>& vec) {
       if(tkn.equals("]"))
         break;
       else
-        vec.push_back(tkn);
+        vec.push_back(tkn.str());
     }
     success = true;
   } else {
     // expecting a single string
     tkn.get("expecting a token");
-    vec.push_back(tkn);
+    vec.push_back(tkn.str());
     success = true;
   }
   return success;
@@ -692,39 +683,36 @@ bool LoaderWrl::loadVecString(Tokenizer&tkn,vector<string>& vec) {
 bool LoaderWrl::load(const char* filename, SceneGraph& wrl) {
   bool success = false;
 
-  FILE* fp = (FILE*)0;
   try {
 
-    // open the file
+    // map the file
     if(filename==(char*)0) throw new StrException("filename==null");
-    fp = fopen(filename,"r");
-    if(fp==(FILE*)0) throw new StrException("fp==(FILE*)0");
+    TokenizerMmap tkn(filename);
+    if(tkn.isOpen()==false) throw new StrException("unable to map file");
 
     // clear the container
     wrl.clear();
     wrl.setUrl(filename);
 
     // read and check header line
-    char header[16];
-    // memset(header,'\0',16);
-    for(int i=0;i<16;i++) header[i] = '\0';
-    fscanf(fp,"%15c",header);
-    if(string(header)!=VRML_HEADER) throw new StrException("header!=VRM_HEADER");
-
-    // create a Tokenizer and start parsing
-    TokenizerFile tkn(fp);
+    const size_t headerLength = strlen(VRML_HEADER);
+    const char*  header       = tkn.getBegin();
+    if((size_t)(tkn.getEnd()-header)<headerLength ||
+       strncmp(header,VRML_HEADER,headerLength)!=0)
+      throw new StrException("header!=VRM_HEADER");
+
+    // start parsing after the header
+    tkn.setPosition(header+headerLength);
     loadSceneGraph(tkn,wrl);
 
     // will be done later
     // wrl.updateBBox();
     
     // if we have reached this point we have succeeded
-    fclose(fp);
     success = true;
 
   } catch(StrException* e) { 
 
-    if(fp!=(FILE*)0) fclose(fp);
     fprintf(stderr,"ERROR | %s\n",e->what());
     delete e;
     wrl.clear();
@@ -734,4 +722,3 @@ bool LoaderWrl::load(const char* filename, SceneGraph& wrl) {
 
   return success;
 }
-
@@ -36,7 +36,7 @@
 #define _LOADER_WRL_HPP_
 
 #include "Loader.hpp"
-#include "Tokenizer.hpp"
+#include "TokenizerMmap.hpp"
 #include <wrl/Transform.hpp>
 #include <wrl/Shape.hpp>
 #include <wrl/Appearance.hpp>
@@ -61,19 +61,20 @@ public:
 
 private:
 
-  bool loadSceneGraph(Tokenizer& tkn, SceneGraph& wrl);
-  bool loadGroup(Tokenizer& tkn, Group& group);
-  bool loadTransform(Tokenizer& tkn, Transform& transform);
-  bool loadChildren(Tokenizer& tkn, Group& group);
-  bool loadShape(Tokenizer& tkn, Shape& transform);
-  bool loadAppearance(Tokenizer& tkn, Appearance& appearance);
-  bool loadMaterial(Tokenizer& tkn, Material& material);
-  bool loadImageTexture(Tokenizer& tkn, ImageTexture& imageTexture);
-  bool loadIndexedFaceSet(Tokenizer& tkn, IndexedFaceSet& ifs);
-  bool loadIndexedLineSet(Tokenizer& tkn, IndexedLineSet& ifs);
-  bool loadVecFloat(Tokenizer& tkn,vector<float>& vec);
-  bool loadVecInt(Tokenizer &tkn,vector<int>& vec);
-  bool loadVecString(Tokenizer &tkn,vector<string>& vec);
+  bool loadSceneGraph(TokenizerMmap& tkn, SceneGraph& wrl);
+  bool loadGroup(TokenizerMmap& tkn, Group& group);
+  bool loadTransform(TokenizerMmap& tkn, Transform& transform);
+  bool loadChildren(TokenizerMmap& tkn, Group& group);
+  bool loadShape(TokenizerMmap& tkn, Shape& transform);
+  bool loadAppearance(TokenizerMmap& tkn, Appearance& appearance);
+  bool loadMaterial(TokenizerMmap& tkn, Material& material);
+  bool loadImageTexture(TokenizerMmap& tkn, ImageTexture& imageTexture);
+  bool loadIndexedFaceSet(TokenizerMmap& tkn, IndexedFaceSet& ifs);
+  bool loadIndexedLineSet(TokenizerMmap& tkn, IndexedLineSet& ifs);
+  bool loadVecFloat(TokenizerMmap& tkn,vector<float>& vec);
+  bool loadVecInt(TokenizerMmap& tkn,vector<int>& vec);
+  bool loadVecInt(TokenizerMmap& tkn,vector<int>& vec,vector<int64_t>& vec64);
+  bool loadVecString(TokenizerMmap& tkn,vector<string>& vec);
 };
 
 #endif /* _LOADER_WRL_HPP_ */
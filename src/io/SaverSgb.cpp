@@ -0,0 +1,251 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// SaverSgb.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+
+#include "SaverSgb.hpp"
+#include "SgbFormat.hpp"
+
+#include "wrl/Transform.hpp"
+#include "wrl/Shape.hpp"
+#include "wrl/Appearance.hpp"
+#include "wrl/Material.hpp"
+#include "wrl/ImageTexture.hpp"
+#include "wrl/IndexedFaceSet.hpp"
+#include "wrl/IndexedLineSet.hpp"
+
+using namespace std;
+
+const char* SaverSgb::_ext = "sgb";
+
+// The arrays are written to the file as the nodes are visited, while
+// the node stream is accumulated in memory, and written at the end.
+
+class _SgbWriter {
+public:
+  FILE*        fp;
+  uint64_t     offset;
+  vector<char> nodes;
+  bool         ok;
+public:
+  _SgbWriter(FILE* f): fp(f), offset(0), nodes(), ok(true) { }
+  void write(const void* data, const size_t n) {
+    if(n>0 && fwrite(data,1,n,fp)!=n) ok = false;
+    offset += n;
+  }
+  void align() {
+    static const char zero[SGB_ALIGNMENT] = { 0 };
+    size_t pad = (size_t)((SGB_ALIGNMENT-offset%SGB_ALIGNMENT)%SGB_ALIGNMENT);
+    write(zero,pad);
+  }
+  void put(const void* data, const size_t n) {
+    const char* c = (const char*)data;
+    nodes.insert(nodes.end(),c,c+n);
+  }
+  void putUInt(const uint32_t u) { put(&u,sizeof(u)); }
+  void putUInt64(const uint64_t u) { put(&u,sizeof(u)); }
+  void putBool(const bool b) { putUInt((b)?1u:0u); }
+  void putFloat(const float f) { put(&f,sizeof(f)); }
+  void putVec3f(Vec3f& v) { putFloat(v.x); putFloat(v.y); putFloat(v.z); }
+  void putColor(const Color& c) { putFloat(c.r); putFloat(c.g); putFloat(c.b); }
+  void putRotation(Rotation& r) { putVec3f(r.getAxis()); putFloat(r.getAngle()); }
+  void putString(const string& s) {
+    putUInt((uint32_t)s.size());
+    put(s.data(),s.size());
+  }
+  template <class T> void putArray(const vector<T>& vec) {
+    uint64_t arrayOffset = 0;
+    if(vec.size()>0) {
+      align();
+      arrayOffset = offset;
+      write(vec.data(),vec.size()*sizeof(T));
+    }
+    putUInt64(arrayOffset);
+    putUInt64((uint64_t)vec.size());
+  }
+};
+
+static void _saveNode(_SgbWriter& w, Node* node);
+
+static void _saveGroup(_SgbWriter& w, Group* group) {
+  w.putVec3f(group->getBBoxCenter());
+  w.putVec3f(group->getBBoxSize());
+  int nChildren = group->getNumberOfChildren();
+  w.putUInt((uint32_t)nChildren);
+  for(int i=0;i<nChildren;i++)
+    _saveNode(w,(*group)[i]);
+}
+
+static void _saveNode(_SgbWriter& w, Node* node) {
+  if(node==(Node*)0) {
+    w.putUInt(SGB_NULL);
+  } else if(node->isTransform()) {
+    Transform* transform = (Transform*)node;
+    w.putUInt(SGB_TRANSFORM);
+    w.putString(node->getName());
+    _saveGroup(w,transform);
+    w.putVec3f(transform->getCenter());
+    w.putRotation(transform->getRotation());
+    w.putVec3f(transform->getScale());
+    w.putRotation(transform->getScaleOrientation());
+    w.putVec3f(transform->getTranslation());
+  } else if(node->isGroup()) {
+    w.putUInt(SGB_GROUP);
+    w.putString(node->getName());
+    _saveGroup(w,(Group*)node);
+  } else if(node->isShape()) {
+    Shape* shape = (Shape*)node;
+    w.putUInt(SGB_SHAPE);
+    w.putString(node->getName());
+    _saveNode(w,shape->getAppearance());
+    Node* geometry = shape->getGeometry();
+    if(geometry!=(Node*)0 &&
+       geometry->isIndexedFaceSet()==false &&
+       geometry->isIndexedLineSet()==false)
+      geometry = (Node*)0;
+    _saveNode(w,geometry);
+  } else if(node->isAppearance()) {
+    Appearance* appearance = (Appearance*)node;
+    w.putUInt(SGB_APPEARANCE);
+    w.putString(node->getName());
+    _saveNode(w,appearance->getMaterial());
+    _saveNode(w,appearance->getTexture());
+  } else if(node->isMaterial()) {
+    Material* material = (Material*)node;
+    w.putUInt(SGB_MATERIAL);
+    w.putString(node->getName());
+    w.putFloat(material->getAmbientIntensity());
+    w.putColor(material->getDiffuseColor());
+    w.putColor(material->getEmissiveColor());
+    w.putFloat(material->getShininess());
+    w.putColor(material->getSpecularColor());
+    w.putFloat(material->getTransparency());
+  } else if(node->isImageTexture()) {
+    ImageTexture* imageTexture = (ImageTexture*)node;
+    w.putUInt(SGB_IMAGE_TEXTURE);
+    w.putString(node->getName());
+    w.putBool(imageTexture->getRepeatS());
+    w.putBool(imageTexture->getRepeatT());
+    vector<string>& url = imageTexture->getUrl();
+    w.putUInt((uint32_t)url.size());
+    for(size_t i=0;i<url.size();i++)
+      w.putString(url[i]);
+  } else if(node->isPixelTexture()) {
+    PixelTexture* pixelTexture = (PixelTexture*)node;
+    w.putUInt(SGB_PIXEL_TEXTURE);
+    w.putString(node->getName());
+    w.putBool(pixelTexture->getRepeatS());
+    w.putBool(pixelTexture->getRepeatT());
+  } else if(node->isIndexedFaceSet()) {
+    IndexedFaceSet& ifs = *((IndexedFaceSet*)node);
+    bool wide = ifs.hasCoordIndex64();
+    w.putUInt((wide)?SGB_INDEXED_FACE_SET_64:SGB_INDEXED_FACE_SET);
+    w.putString(node->getName());
+    w.putBool(ifs.getCcw());
+    w.putBool(ifs.getConvex());
+    w.putBool(ifs.getSolid());
+    w.putFloat(ifs.getCreaseangle());
+    w.putBool(ifs.getNormalPerVertex());
+    w.putBool(ifs.getColorPerVertex());
+    w.putArray(ifs.getCoord());
+    if(wide)
+      w.putArray(ifs.getCoordIndex64());
+    else
+      w.putArray(ifs.getCoordIndex());
+    w.putArray(ifs.getNormal());
+    w.putArray(ifs.getNormalIndex());
+    w.putArray(ifs.getColor());
+    w.putArray(ifs.getColorIndex());
+    w.putArray(ifs.getTexCoord());
+    w.putArray(ifs.getTexCoordIndex());
+  } else if(node->isIndexedLineSet()) {
+    IndexedLineSet& ils = *((IndexedLineSet*)node);
+    w.putUInt(SGB_INDEXED_LINE_SET);
+    w.putString(node->getName());
+    w.putBool(ils.getColorPerVertex());
+    w.putArray(ils.getCoord());
+    w.putArray(ils.getCoordIndex());
+    w.putArray(ils.getColor());
+    w.putArray(ils.getColorIndex());
+  } else {
+    // unsupported node types are dropped
+    w.putUInt(SGB_NULL);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+bool SaverSgb::save(const char* filename, SceneGraph& wrl) const {
+  bool success = false;
+  if(filename!=(char*)0) {
+    FILE* fp = fopen(filename,"wb");
+    if(fp!=(FILE*)0) {
+      _SgbWriter w(fp);
+
+      // the header is written at the end, when the offsets are known
+      char header[SGB_HEADER_SIZE];
+      memset(header,0,SGB_HEADER_SIZE);
+      w.write(header,SGB_HEADER_SIZE);
+
+      // the SceneGraph is stored as a Group
+      w.putUInt(SGB_GROUP);
+      w.putString(wrl.getName());
+      _saveGroup(w,&wrl);
+
+      w.align();
+      uint64_t nodesOffset = w.offset;
+      uint64_t nodesSize   = (uint64_t)w.nodes.size();
+      w.write(w.nodes.data(),w.nodes.size());
+      uint64_t fileSize    = w.offset;
+
+      uint32_t version     = SGB_VERSION;
+      uint32_t byteOrder   = SGB_BYTE_ORDER;
+      memcpy(header,SGB_MAGIC,strlen(SGB_MAGIC)+1);
+      memcpy(header+ 8,&version,4);
+      memcpy(header+12,&byteOrder,4);
+      memcpy(header+16,&nodesOffset,8);
+      memcpy(header+24,&nodesSize,8);
+      memcpy(header+32,&fileSize,8);
+      if(fseek(fp,0,SEEK_SET)!=0) w.ok = false;
+      if(fwrite(header,1,SGB_HEADER_SIZE,fp)!=SGB_HEADER_SIZE) w.ok = false;
+
+      if(fclose(fp)!=0) w.ok = false;
+      success = w.ok;
+    }
+  }
+  return success;
+}
@@ -40,9 +40,12 @@
 #include "wrl/Appearance.hpp"
 #include "wrl/Material.hpp"
 #include "wrl/IndexedFaceSet.hpp"
-#include "core/Faces.hpp"
+#include "core/FaceIteration.hpp"
+#include "core/TriangleNormals.hpp"
 #include <cmath>
+#include <string.h>
 #include <vector>
+#include <type_traits>
 #include "wrl/Node.hpp"
 #include "wrl/Group.hpp"
 
@@ -77,61 +80,114 @@ bool SaverStl::save(const char* filename, SceneGraph& wrl) const {
     if (ifs == (IndexedFaceSet*)0) return false;
 
 
-    // - construct an instance of the Faces class from the IndexedFaceSet
-    //we need first get the data and then construct faces
-    int nV = ifs->getNumberOfCoord();
+    // the faces are traversed directly on the coordIndex array, or
+    // on the coordIndex64 array of meshes too large for 32 bit
+    // indices, with the loops defined in core/FaceIteration.hpp
     const vector<int>& coordIndex = ifs->getCoordIndex();
+    const vector<int64_t>& coordIndex64 = ifs->getCoordIndex64();
+    bool wide = ifs->hasCoordIndex64();
     const vector<float>& coord = ifs->getCoord();
 
-    //construct faces
-    Faces* faces = new Faces(nV, coordIndex);
-
-    // - remember to delete it when you are done with it (if necessary)
-    //   before returning
-
     // 4) the IndexedFaceSet should be a triangle mesh
     // 5) the IndexedFaceSet should have normals per face
 
+    // polygons are saved as triangle fans; the stored face normals
+    // are used if present, and computed otherwise
+    IndexedFaceSet::Binding nb = ifs->getNormalBinding();
+    const vector<float>& normal = ifs->getNormal();
+    const vector<int>& normalIndex = ifs->getNormalIndex();
+    bool perFace = (nb==IndexedFaceSet::PB_PER_FACE ||
+                    nb==IndexedFaceSet::PB_PER_FACE_INDEXED);
+
+    size_t nTriangles = 0;
+    auto countTriangles = [&](auto, auto iC0, auto iC1) {
+        if (iC1-iC0 >= 3) nTriangles += (size_t)(iC1-iC0-2);
+    };
+    if (wide) forEachFace(coordIndex64, countTriangles);
+    else      forEachFace(coordIndex, countTriangles);
+    bool binary =
+      (_format==BINARY) ||
+      (_format==AUTO && nTriangles>(size_t)_binaryThreshold);
+    // the binary format stores the number of triangles in 32 bits
+    if (nTriangles > 0xffffffffull) {
+        if (_format==BINARY) return false;
+        binary = false;
+    }
+
     // if (all the conditions are satisfied) {
 
-    FILE* fp = fopen(filename,"w");
+    FILE* fp = fopen(filename,(binary)?"wb":"w");
     if(	fp!=(FILE*)0) {
 
       // if set, use ifs->getName()
       // otherwise use filename,
       // but first remove directory and extension
 
-      fprintf(fp,"solid %s\n",filename);
+      // binary STL records are 50 bytes long: normal, three vertices,
+      // and a 2 byte attribute, which is not used; they are written
+      // through a buffer, in blocks of about 1MB
+      vector<char> buffer;
+      char* record = (char*)0;
+      if (binary) {
+          char header[80];
+          memset(header, ' ', 80);
+          const char* text = "binary STL";
+          memcpy(header, text, strlen(text));
+          unsigned int n = (unsigned int)nTriangles;
+          fwrite(header, 1, 80, fp);
+          fwrite(&n, 4, 1, fp);
+          buffer.resize(50*20000);
+          record = buffer.data();
+      } else {
+          fprintf(fp,"solid %s\n",filename);
+      }
 
       // TODO ...
       // for each face {
-      for (int iF = 0; iF < faces->getNumberOfFaces(); ++iF) {
-          //get the number of vertices of faces
-          int nCorners = faces->getFaceSize(iF);
-          if (nCorners < 3) continue;
+      // the triangles are written by a generic lambda, instantiated
+      // for each index type; fn is the normal computed by the
+      // triangle normal kernel, if any
+      auto saveTriangle = [&](const auto* ci, auto iF, auto iC0, auto iC1, auto iC2,
+                              const float* fn) {
+          if (fn == (const float*)0 && perFace) {
+              int64_t iN = (nb==IndexedFaceSet::PB_PER_FACE)?(int64_t)iF:
+                (((size_t)iF<normalIndex.size())?normalIndex[iF]:-1);
+              if (iN >= 0 && 3*(size_t)iN+2 < normal.size()) fn = &normal[3*iN];
+          }
 
           //process the geometry data
-          //garuantee it must be triangle
-          int v0 = faces->getFaceVertex(iF, 0);
-          float p0[3] = { coord[3*v0], coord[3*v0+1], coord[3*v0+2] };
-
-          for (int k = 2; k < nCorners; ++k){
-              int v1 = faces->getFaceVertex(iF, k-1);
-              int v2 = faces->getFaceVertex(iF, k);
-
-              float p1[3] = { coord[3*v1], coord[3*v1+1], coord[3*v1+2] };
-              float p2[3] = { coord[3*v2], coord[3*v2+1], coord[3*v2+2] };
-
+          const float* p0 = &coord[3*(size_t)ci[iC0]];
+          const float* p1 = &coord[3*(size_t)ci[iC1]];
+          const float* p2 = &coord[3*(size_t)ci[iC2]];
+
+          float nx, ny, nz;
+          if (fn != (const float*)0) {
+              nx = fn[0]; ny = fn[1]; nz = fn[2];
+          } else {
               float u[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] };
               float v[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] };
 
-              float nx = u[1]*v[2] - u[2]*v[1];
-              float ny = u[2]*v[0] - u[0]*v[2];
-              float nz = u[0]*v[1] - u[1]*v[0];
+              nx = u[1]*v[2] - u[2]*v[1];
+              ny = u[2]*v[0] - u[0]*v[2];
+              nz = u[0]*v[1] - u[1]*v[0];
 
               float len = sqrt(nx*nx + ny*ny + nz*nz);
               if (len > 0) { nx/=len; ny/=len; nz/=len; }
+          }
 
+          if (binary) {
+              float r[12] = { nx, ny, nz,
+                              p0[0], p0[1], p0[2],
+                              p1[0], p1[1], p1[2],
+                              p2[0], p2[1], p2[2] };
+              memcpy(record, r, 48);
+              record[48] = record[49] = 0;
+              record += 50;
+              if (record == buffer.data()+buffer.size()) {
+                  fwrite(buffer.data(), 1, buffer.size(), fp);
+                  record = buffer.data();
+              }
+          } else {
               fprintf(fp, "  facet normal %f %f %f\n", nx, ny, nz);
               fprintf(fp, "    outer loop\n");
               fprintf(fp, "      vertex %f %f %f\n", p0[0], p0[1], p0[2]);
@@ -139,16 +195,47 @@ bool SaverStl::save(const char* filename, SceneGraph& wrl) const {
               fprintf(fp, "      vertex %f %f %f\n", p2[0], p2[1], p2[2]);
               fprintf(fp, "    endloop\n");
               fprintf(fp, "  endfacet\n");
-
           }
-
-      }
+      };
+      // the normals of triangle meshes without stored face normals
+      // are computed by the vector kernels, one block of records at a
+      // time
+      auto saveTriangles = [&](const auto& ci) {
+          typedef typename std::decay<decltype(ci[0])>::type Index;
+          const size_t nC = ci.size();
+          if (!perFace && isTriangleMesh(ci.data(), (Index)nC)) {
+              const size_t nT = nC/4, nB = 20000;
+              vector<float> blockNormal(3*nB);
+              for (size_t iT0 = 0; iT0 < nT; iT0 += nB) {
+                  const size_t nTB = (nT-iT0 < nB)?nT-iT0:nB;
+                  TriangleNormals::compute(coord.data(), coord.size()/3,
+                                           ci.data()+4*iT0, nTB, blockNormal.data());
+                  for (size_t iT = 0; iT < nTB; iT++) {
+                      const Index iC = (Index)(4*(iT0+iT));
+                      saveTriangle(ci.data(), (Index)(iT0+iT), iC, iC+1, iC+2,
+                                   &blockNormal[3*iT]);
+                  }
+              }
+          } else {
+              forEachTriangle(ci, [&](Index iF, Index iC0, Index iC1, Index iC2) {
+                  saveTriangle(ci.data(), iF, iC0, iC1, iC2, (const float*)0);
+              });
+          }
+      };
+      if (wide) saveTriangles(coordIndex64);
+      else      saveTriangles(coordIndex);
 
       //   ...
       // }
-      fprintf(fp, "endsolid %s\n", filename);
+      if (binary) {
+          if (record > buffer.data())
+              fwrite(buffer.data(), 1, (size_t)(record-buffer.data()), fp);
+          success = (ferror(fp)==0);
+      } else {
+          fprintf(fp, "endsolid %s\n", filename);
+          success = true;
+      }
       fclose(fp);
-      success = true;
     }
 
     // } endif (all the conditions are satisfied)
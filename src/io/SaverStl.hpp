@@ -47,14 +47,26 @@ const static char* _ext;
 
 public:
 
-  SaverStl()  {};
+  // In AUTO mode, meshes with more than getBinaryThreshold()
+  // triangles are saved in binary format, and smaller ones in ASCII.
+  enum Format { ASCII = 0, BINARY, AUTO };
+
+  SaverStl(): _format(AUTO), _binaryThreshold(100000) {};
   ~SaverStl() {};
 
   bool  save(const char* filename, SceneGraph& wrl) const;
   const char* ext() const { return _ext; }
+
+  void   setFormat(const Format format) { _format = format; }
+  Format getFormat() const { return _format; }
+  void   setBinaryThreshold(const int nTriangles) { _binaryThreshold = nTriangles; }
+  int    getBinaryThreshold() const { return _binaryThreshold; }
   
 private:
 
+  Format _format;
+  int    _binaryThreshold;
+
 };
 
 #endif /* _SAVER_STL_HPP_ */
@@ -33,9 +33,91 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "SaverWrl.hpp"
+#include "BufferedWriter.hpp"
+#include "util/Parallel.hpp"
+
+#include <functional>
 
 const char* SaverWrl::_ext = "wrl";
 
+// Array fields are written through a BufferedWriter, one face or one
+// tuple of values per line, rather than with one fprintf per value.
+//
+// Large arrays are formatted in parallel. The array is divided into
+// chunks of _chunkSize values, which are processed in rounds of two
+// chunks per thread; the chunks of a round are formatted into
+// separate memory buffers, which are then written to the file in
+// order. Since the formatting of a value only depends on its index
+// and on the preceding value, the output is identical to the output
+// of the serial path.
+
+static const size_t _chunkSize = 1<<16;
+
+typedef function<void(BufferedWriter&,size_t,size_t)> _FormatRange;
+
+static void _formatChunks
+(BufferedWriter& out, const size_t n, const _FormatRange& format) {
+  size_t nThreads = Parallel::getNumberOfThreads();
+  if(nThreads<=1 || n<2*_chunkSize) {
+    format(out,0,n);
+    return;
+  }
+  size_t nChunks = (n+_chunkSize-1)/_chunkSize;
+  size_t nRound  = 2*nThreads;
+  vector<BufferedWriter*> buffer(nRound,(BufferedWriter*)0);
+  for(size_t k=0;k<nRound;k++)
+    buffer[k] = new BufferedWriter((FILE*)0,12*_chunkSize);
+  for(size_t c0=0;c0<nChunks;c0+=nRound) {
+    size_t c1 = (c0+nRound<nChunks)?c0+nRound:nChunks;
+    Parallel::forEach(c1-c0,[&](size_t k) {
+      size_t i0 = (c0+k)*_chunkSize;
+      size_t i1 = (i0+_chunkSize<n)?i0+_chunkSize:n;
+      buffer[k]->clear();
+      format(*buffer[k],i0,i1);
+    });
+    for(size_t k=0;k<c1-c0;k++)
+      out.write(buffer[k]->getData(),buffer[k]->getSize());
+  }
+  for(size_t k=0;k<nRound;k++)
+    delete buffer[k];
+}
+
+// both return false if the data could not be written to the file
+
+template <class Index>
+static bool _saveVecInt
+(FILE* fp, const string& indent, const vector<Index>& vec, const int width) {
+  BufferedWriter out(fp);
+  _formatChunks(out,vec.size(),[&](BufferedWriter& w, size_t i0, size_t i1) {
+    bool newLine = (i0==0 || vec[i0-1]<0);
+    for(size_t i=i0;i<i1;i++) {
+      if(newLine) w.write(indent); else w.put(' ');
+      w.writeInt(vec[i],width);
+      newLine = (vec[i]<0);
+      if(newLine) w.put('\n');
+    }
+  });
+  if(vec.size()>0 && vec.back()>=0) out.put('\n');
+  out.flush();
+  return out.isOk();
+}
+
+static bool _saveVecFloat
+(FILE* fp, const string& indent, const vector<float>& vec, const int tupleSize) {
+  BufferedWriter out(fp);
+  _formatChunks(out,vec.size(),[&](BufferedWriter& w, size_t i0, size_t i1) {
+    for(size_t i=i0;i<i1;i++) {
+      size_t j = i%tupleSize;
+      if(j==0) w.write(indent); else w.put(' ');
+      w.writeFloat(vec[i],4,8);
+      if(j==(size_t)(tupleSize-1)) w.put('\n');
+    }
+  });
+  if(vec.size()%tupleSize!=0) out.put('\n');
+  out.flush();
+  return out.isOk();
+}
+
 //////////////////////////////////////////////////////////////////////
 void SaverWrl::saveMaterial
 (FILE* fp, string indent, Material* material) const {
@@ -168,9 +250,10 @@ void SaverWrl::saveAppearance
 }
 
 //////////////////////////////////////////////////////////////////////
-void SaverWrl::saveIndexedFaceSet
+bool SaverWrl::saveIndexedFaceSet
 (FILE* fp, string indent, IndexedFaceSet* indexedFaceSet) const {
-  if(indexedFaceSet==(IndexedFaceSet*)0) return;
+  if(indexedFaceSet==(IndexedFaceSet*)0) return true;
+  bool success = true;
 
   const char* str = indent.c_str();
 
@@ -207,6 +290,7 @@ void SaverWrl::saveIndexedFaceSet
   bool&          colorPerVertex  = ifs.getColorPerVertex();
   vector<float>& coord           = ifs.getCoord();
   vector<int>&   coordIndex      = ifs.getCoordIndex();
+  vector<int64_t>& coordIndex64  = ifs.getCoordIndex64();
   vector<float>& normal          = ifs.getNormal();
   vector<int>&   normalIndex     = ifs.getNormalIndex();
   vector<float>& color           = ifs.getColor();
@@ -224,25 +308,21 @@ void SaverWrl::saveIndexedFaceSet
   // default creaseAngle 0.0
   if(creaseAngle>0.0) fprintf(fp,"%s creaseAngle %8.4f\n",str,creaseAngle);
 
-  if(coordIndex.size()>0) {
-    int i;
+  if(coordIndex64.size()>0) {
     fprintf(fp,"%s coordIndex [\n",str);
-    for(i=0;i<(int)coordIndex.size();i++) {
-      fprintf(fp,"%s%6d ",str,coordIndex[i]);
-      if(coordIndex[i]<0) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecInt(fp,indent+"   ",coordIndex64,6);
+    fprintf(fp,"%s ]\n",str);
+  } else if(coordIndex.size()>0) {
+    fprintf(fp,"%s coordIndex [\n",str);
+    success &= _saveVecInt(fp,indent+"   ",coordIndex,6);
     fprintf(fp,"%s ]\n",str);
   }
 
   // COORD_PER_VERTEX
   if(coord.size()>0) {
-    int i;
     fprintf(fp,"%s coord Coordinate {\n",str);
     fprintf(fp,"%s  point [\n",str);
-    for(i=0;i<(int)coord.size();i++) {
-      fprintf(fp,"%s%8.4f ",str,coord[i]);
-      if(i%3==2) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecFloat(fp,indent+"    ",coord,3);
     fprintf(fp,"%s  ]\n",str);
     fprintf(fp,"%s }\n",str);
   }
@@ -265,25 +345,18 @@ void SaverWrl::saveIndexedFaceSet
   //     normal.size()/3==coord.size()/3
 
   if(normal.size()>0) {
-    int i;
     fprintf(fp,"%s normalPerVertex %s\n",str,
             (normalPerVertex==true)?"TRUE":"FALSE");
 
     fprintf(fp,"%s normal Normal {\n",str);
     fprintf(fp,"%s  vector [\n",str);
-    for(i=0;i<(int)normal.size();i++) {
-      fprintf(fp,"%s%8.4f ",str,normal[i]);
-      if(i%3==2) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecFloat(fp,indent+"    ",normal,3);
     fprintf(fp,"%s  ]\n",str);
     fprintf(fp,"%s }\n",str);
 
     if(normalIndex.size()>0) {
       fprintf(fp,"%s normalIndex [\n",str);
-      for(i=0;i<(int)normalIndex.size();i++) {
-        fprintf(fp,"%s%d ",str,normalIndex[i]);
-        if(normalIndex[i]<0) fprintf(fp,"%s\n",str);
-      }
+      success &= _saveVecInt(fp,indent+"   ",normalIndex,0);
       fprintf(fp,"%s ]\n",str);
     }
   }
@@ -306,25 +379,18 @@ void SaverWrl::saveIndexedFaceSet
   //     color.size()/3==coord.size()/3
 
   if(color.size()>0) {
-    int i;
     fprintf(fp,"%s colorPerVertex %s\n",str,
             (colorPerVertex==true)?"TRUE":"FALSE");
 
     fprintf(fp,"%s color Color {\n",str);
     fprintf(fp,"%s  color [\n",str);
-    for(i=0;i<(int)color.size();i++) {
-      fprintf(fp,"%s%8.4f ",str,color[i]);
-      if(i%3==2) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecFloat(fp,indent+"    ",color,3);
     fprintf(fp,"%s  ]\n",str);
     fprintf(fp,"%s }\n",str);
 
     if(colorIndex.size()>0) {
       fprintf(fp,"%s colorIndex [\n",str);
-      for(i=0;i<(int)colorIndex.size();i++) {
-        fprintf(fp,"%s%d ",str,colorIndex[i]);
-        if(colorIndex[i]<0) fprintf(fp,"%s\n",str);
-      }
+      success &= _saveVecInt(fp,indent+"   ",colorIndex,0);
       fprintf(fp,"%s ]\n",str);
     }
   }
@@ -339,34 +405,29 @@ void SaverWrl::saveIndexedFaceSet
   //   texCoord.size()/2==coord.size()/3
 
   if(texCoord.size()>0) {
-    int i;
 
     fprintf(fp,"%s texCoord TextureCoordinate {\n",str);
     fprintf(fp,"%s  point [\n",str);
-    for(i=0;i<(int)texCoord.size();i++) {
-      fprintf(fp,"%s%8.4f ",str,texCoord[i]);
-      if(i%2==1) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecFloat(fp,indent+"    ",texCoord,2);
     fprintf(fp,"%s  ]\n",str);
     fprintf(fp,"%s }\n",str);
 
     if(texCoordIndex.size()>0) {
       fprintf(fp,"%s texCoordIndex [\n",str);
-      for(i=0;i<(int)texCoordIndex.size();i++) {
-        fprintf(fp,"%s%d ",str,texCoordIndex[i]);
-        if(texCoordIndex[i]<0) fprintf(fp,"%s\n",str);
-      }
+      success &= _saveVecInt(fp,indent+"   ",texCoordIndex,0);
       fprintf(fp,"%s ]\n",str);
     }
   }
 
   fprintf(fp,"%s}\n",str); // IndexedFaceSet
+  return success;
 }
 
 //////////////////////////////////////////////////////////////////////
-void SaverWrl::saveIndexedLineSet
+bool SaverWrl::saveIndexedLineSet
 (FILE* fp, string indent, IndexedLineSet* indexedLineSet) const {
-  if(indexedLineSet==(IndexedLineSet*)0) return;
+  if(indexedLineSet==(IndexedLineSet*)0) return true;
+  bool success = true;
 
   const char* str = indent.c_str();
 
@@ -393,59 +454,46 @@ void SaverWrl::saveIndexedLineSet
   bool&          colorPerVertex  = ifs.getColorPerVertex();
 
   {
-    int i;
     fprintf(fp,"%s coordIndex [\n",str);
-    for(i=0;i<(int)coordIndex.size();i++) {
-      fprintf(fp,"%s%6d ",str,coordIndex[i]);
-      if(coordIndex[i]<0) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecInt(fp,indent+"   ",coordIndex,6);
     fprintf(fp,"%s ]\n",str);
   }
 
   // COORD_PER_VERTEX
   {
-    int i;
     fprintf(fp,"%s coord Coordinate {\n",str);
     fprintf(fp,"%s  point [\n",str);
-    for(i=0;i<(int)coord.size();i++) {
-      fprintf(fp,"%s%8.4f ",str,coord[i]);
-      if(i%3==2) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecFloat(fp,indent+"    ",coord,3);
     fprintf(fp,"%s  ]\n",str);
     fprintf(fp,"%s }\n",str);
   }
 
   if(color.size()>0) {
-    int i;
     fprintf(fp,"%s colorPerVertex %s\n",str,
             (colorPerVertex==true)?"TRUE":"FALSE");
 
     fprintf(fp,"%s color Color {\n",str);
     fprintf(fp,"%s  color [\n",str);
-    for(i=0;i<(int)color.size();i++) {
-      fprintf(fp,"%s%8.4f ",str,color[i]);
-      if(i%3==2) fprintf(fp,"%s\n",str);
-    }
+    success &= _saveVecFloat(fp,indent+"    ",color,3);
     fprintf(fp,"%s  ]\n",str);
     fprintf(fp,"%s }\n",str);
 
     if(colorIndex.size()>0) {
       fprintf(fp,"%s colorIndex [\n",str);
-      for(i=0;i<(int)colorIndex.size();i++) {
-        fprintf(fp,"%s%d ",str,colorIndex[i]);
-        if(colorIndex[i]<0) fprintf(fp,"%s\n",str);
-      }
+      success &= _saveVecInt(fp,indent+"   ",colorIndex,0);
       fprintf(fp,"%s ]\n",str);
     }
   }
 
   fprintf(fp,"%s}\n",str); // IndexedLineSet
+  return success;
 }
 
 //////////////////////////////////////////////////////////////////////
-void SaverWrl::saveShape
+bool SaverWrl::saveShape
 (FILE* fp, string indent, Shape* shape) const {
-  if(shape==(Shape*)0) return;
+  if(shape==(Shape*)0) return true;
+  bool success = true;
 
   const char* str = indent.c_str();
 
@@ -473,22 +521,24 @@ void SaverWrl::saveShape
     if(node->isIndexedFaceSet()) {
       fprintf(fp,"%s geometry\n",str);
       IndexedFaceSet* indexedFaceSet = (IndexedFaceSet*)node;
-      saveIndexedFaceSet(fp,indent+"  ",indexedFaceSet);
+      success &= saveIndexedFaceSet(fp,indent+"  ",indexedFaceSet);
     } else if(node->isIndexedLineSet()) {
       fprintf(fp,"%s geometry\n",str);
       IndexedLineSet* indexedLineSet = (IndexedLineSet*)node;
-      saveIndexedLineSet(fp,indent+"  ",indexedLineSet);
+      success &= saveIndexedLineSet(fp,indent+"  ",indexedLineSet);
     } else {
       // TBD
     }
   }
   fprintf(fp,"%s}\n",str);
+  return success;
 }
 
 //////////////////////////////////////////////////////////////////////
-void SaverWrl::saveTransform
+bool SaverWrl::saveTransform
 (FILE* fp, string indent, Transform* transform) const {
-  if(transform==(Transform*)0) return;
+  if(transform==(Transform*)0) return true;
+  bool success = true;
 
   const char* str = indent.c_str();
 
@@ -555,11 +605,11 @@ void SaverWrl::saveTransform
     for(int i=0;i<nChildren;i++) {
       node = (*transform)[i];
       if(node->isShape()) {
-        saveShape(fp,indent+"  ",(Shape*)node);
+        success &= saveShape(fp,indent+"  ",(Shape*)node);
 	  } else if(node->isTransform()) {
-        saveTransform(fp,indent+"  ",(Transform*)node);
+        success &= saveTransform(fp,indent+"  ",(Transform*)node);
 	  } else if(node->isGroup()) {
-        saveGroup(fp,indent+"  ",(Group*)node);
+        success &= saveGroup(fp,indent+"  ",(Group*)node);
       } else {
         // throw StrException("unexpected node type as child of Transform");
       }
@@ -568,12 +618,14 @@ void SaverWrl::saveTransform
   }
 
   fprintf(fp,"%s}\n",str);
+  return success;
 }
 
 //////////////////////////////////////////////////////////////////////
-void SaverWrl::saveGroup
+bool SaverWrl::saveGroup
 (FILE* fp, string indent, Group* group) const {
-  if(group==(Group*)0) return;
+  if(group==(Group*)0) return true;
+  bool success = true;
 
   const char* str = indent.c_str();
 
@@ -605,11 +657,11 @@ void SaverWrl::saveGroup
     for(int i=0;i<nChildren;i++) {
       node = (*group)[i];
       if(node->isShape()) {
-        saveShape(fp,indent+" ",(Shape*)node);
+        success &= saveShape(fp,indent+" ",(Shape*)node);
 	  } else if(node->isTransform()) {
-        saveTransform(fp,indent+" ",(Transform*)node);
+        success &= saveTransform(fp,indent+" ",(Transform*)node);
 	  } else if(node->isGroup()) {
-        saveGroup(fp,indent+" ",(Group*)node);
+        success &= saveGroup(fp,indent+" ",(Group*)node);
       } else {
         // throw StrException("unexpected node type as child of Transform");
       }
@@ -617,6 +669,7 @@ void SaverWrl::saveGroup
   }
 
   fprintf(fp,"%s}\n",str);
+  return success;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -625,6 +678,7 @@ bool SaverWrl::save(const char* filename, SceneGraph& wrl) const {
   if(filename!=(char*)0) {
      FILE* fp = fopen(filename,"w");
     if(	fp!=(FILE*)0) {
+      success = true;
       fprintf(fp,"#VRML V2.0 utf8\n");
       string indent="";
       int nChildren = wrl.getNumberOfChildren();
@@ -632,17 +686,19 @@ bool SaverWrl::save(const char* filename, SceneGraph& wrl) const {
         Node* node = wrl[i];
         if(node->isShape()) {
           Shape* shape = (Shape*)node;
-          saveShape(fp,indent,shape);
+          success &= saveShape(fp,indent,shape);
         } else if(node->isTransform()) {
           Transform* transform = (Transform*)node;
-          saveTransform(fp,indent,transform);
+          success &= saveTransform(fp,indent,transform);
         } else if(node->isGroup()) {
           Group* group = (Group*)node;
-          saveGroup(fp,indent,group);
+          success &= saveGroup(fp,indent,group);
         }
       }
-      fclose(fp);
-      success = true;
+      // the arrays report their own write errors; ferror() covers
+      // everything written with fprintf, and fclose() the final flush
+      if(ferror(fp)!=0) success = false;
+      if(fclose(fp)!=0) success = false;
     }
   }
   return success;
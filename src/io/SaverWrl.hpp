@@ -63,19 +63,19 @@ private:
   
   void saveAppearance
   (FILE* fp, string indent, Appearance* appearance) const;
-  void saveGroup
+  bool saveGroup
   (FILE* fp, string indent, Group* group) const;
   void saveImageTexture
   (FILE* fp, string indent, ImageTexture* imageTexture) const;
-  void saveIndexedFaceSet
+  bool saveIndexedFaceSet
   (FILE* fp, string indent, IndexedFaceSet* indexedFaceSet) const;
-  void saveIndexedLineSet
+  bool saveIndexedLineSet
   (FILE* fp, string indent, IndexedLineSet* indexedLineSet) const;
   void saveMaterial
   (FILE* fp, string indent, Material* material) const;
-  void saveShape
+  bool saveShape
   (FILE* fp, string indent, Shape* shape) const;
-  void saveTransform
+  bool saveTransform
   (FILE* fp, string indent, Transform* transform) const;
   
 };
@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// SgbFormat.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _SGB_FORMAT_HPP_
+#define _SGB_FORMAT_HPP_
+
+#include <stdint.h>
+
+// Binary scene graph format, written by SaverSgb and read by
+// LoaderSgb. All values are stored in the byte order of the machine
+// which wrote the file; files written with a different byte order
+// are rejected by the loader.
+//
+// header, 64 bytes
+//   char     magic[8]     SGB_MAGIC
+//   uint32   version      SGB_VERSION
+//   uint32   byteOrder    SGB_BYTE_ORDER
+//   uint64   nodesOffset  offset of the node stream
+//   uint64   nodesSize    size of the node stream in bytes
+//   uint64   fileSize
+//   (zero padding)
+//
+// array data
+//   the contents of all the arrays, each one starting at an offset
+//   which is a multiple of SGB_ALIGNMENT
+//
+// node stream
+//   the nodes of the scene graph in depth first order, starting with
+//   the SceneGraph itself, which is stored as a Group; each node is
+//   stored as
+//     uint32  type        one of the SGB_* node types below
+//     string  name
+//     fields, which depend on the type
+//   and SGB_NULL, not followed by anything, is stored for a missing
+//   SFNode field
+//
+//   string     uint32 length, followed by the characters
+//   bool       uint32, 0 or 1
+//   float      float32
+//   vec3f      3 floats
+//   rotation   4 floats, axis and angle
+//   color      3 floats
+//   array      uint64 offset, uint64 number of elements; the elements
+//              are 4 byte int32 or float32 values, except for the
+//              coordIndex array of IndexedFaceSet64, which stores 8
+//              byte int64 values
+//
+//   Group          vec3f bboxCenter, vec3f bboxSize,
+//                  uint32 nChildren, children
+//   Transform      Group fields, followed by vec3f center, rotation
+//                  rotation, vec3f scale, rotation scaleOrientation,
+//                  vec3f translation
+//   Shape          node appearance, node geometry
+//   Appearance     node material, node texture
+//   Material       float ambientIntensity, color diffuseColor,
+//                  color emissiveColor, float shininess,
+//                  color specularColor, float transparency
+//   PixelTexture   bool repeatS, bool repeatT
+//   ImageTexture   PixelTexture fields, uint32 nUrl, string url[nUrl]
+//   IndexedFaceSet bool ccw, bool convex, bool solid,
+//                  float creaseAngle, bool normalPerVertex,
+//                  bool colorPerVertex, array coord, array coordIndex,
+//                  array normal, array normalIndex, array color,
+//                  array colorIndex, array texCoord, array texCoordIndex
+//   IndexedFaceSet64
+//                  the same fields, used for meshes whose faces are
+//                  stored in the 64 bit coordIndex64 array
+//   IndexedLineSet bool colorPerVertex, array coord, array coordIndex,
+//                  array color, array colorIndex
+
+#define SGB_MAGIC          "DGP-SGB"
+#define SGB_VERSION        1u
+#define SGB_BYTE_ORDER     0x01020304u
+#define SGB_HEADER_SIZE    64
+#define SGB_ALIGNMENT      64
+
+#define SGB_NULL           0u
+#define SGB_GROUP          1u
+#define SGB_TRANSFORM      2u
+#define SGB_SHAPE          3u
+#define SGB_APPEARANCE     4u
+#define SGB_MATERIAL       5u
+#define SGB_PIXEL_TEXTURE  6u
+#define SGB_IMAGE_TEXTURE  7u
+#define SGB_INDEXED_FACE_SET 8u
+#define SGB_INDEXED_LINE_SET 9u
+#define SGB_INDEXED_FACE_SET_64 10u
+
+#endif /* _SGB_FORMAT_HPP_ */
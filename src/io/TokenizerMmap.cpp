@@ -0,0 +1,521 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// TokenizerMmap.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <charconv>
+#include "TokenizerMmap.hpp"
+#include "StrException.hpp"
+#include "util/Parallel.hpp"
+
+// same separators as Tokenizer::get()
+static const bool _blank[256] = {
+  false,false,false,false,false,false,false,false, // 000-007
+  false,true ,true ,false,false,true ,false,false, // 010-017 \t \n \r
+  false,false,false,false,false,false,false,false, // 020-027
+  false,false,false,false,false,false,false,false, // 030-037
+  true ,false,false,false,false,false,false,false, // 040-047 ' '
+  false,false,false,false,true ,false,false,false  // 050-057 ','
+  // the rest are false
+};
+
+static inline bool _isBlank(const char c) {
+  return _blank[(unsigned char)c];
+}
+
+TokenizerMmap::TokenizerMmap(const char* filename):
+  _map(filename),
+  _begin(_map.getData()),
+  _end(_map.getData()+_map.getSize()),
+  _pos(_begin),
+  _skip(true) {
+}
+
+TokenizerMmap::TokenizerMmap(const char* begin, const char* end):
+  _begin(begin),
+  _end(end),
+  _pos(begin),
+  _skip(true) {
+}
+
+bool TokenizerMmap::isOpen() const {
+  return _begin!=(const char*)0;
+}
+
+void TokenizerMmap::setPosition(const char* pos) {
+  _pos = (pos<_begin)?_begin:(pos>_end)?_end:pos;
+  _tkn = string_view();
+}
+
+void TokenizerMmap::setSkipComments(const bool value) {
+  _skip = value;
+}
+
+bool TokenizerMmap::get() {
+  const char* p   = _pos;
+  const char* end = _end;
+  const char* t;
+  do {
+    // skip blank space
+    while(p<end && _isBlank(*p)) p++;
+    // collect token characters
+    t = p;
+    while(p<end && !_isBlank(*p)) p++;
+    // if comment, get the rest of the line, including blank spaces
+    if(p>t && *t=='#')
+      while(p<end && *p!='\n') p++;
+  } while(_skip && p>t && *t=='#');
+  _tkn = string_view(t,(size_t)(p-t));
+  // as Tokenizer::get(), consume the separator following the token
+  _pos = (p<end)?p+1:p;
+  return (p>t)?true:false;
+}
+
+void TokenizerMmap::get(const string& errMsg) /* throw(StrException *) */ {
+  if(get()==false) throw new StrException(errMsg);
+}
+
+bool TokenizerMmap::getline() {
+  const char* p   = _pos;
+  const char* end = _end;
+  const char* t   = p;
+  while(p<end && *p!='\n') p++;
+  _tkn = string_view(t,(size_t)(p-t));
+  _pos = (p<end)?p+1:p;
+  return (p>t)?true:false;
+}
+
+void TokenizerMmap::nextline() {
+  const char* p   = _pos;
+  const char* end = _end;
+  while(p<end && *p!='\n') p++;
+  _pos = (p<end)?p+1:p;
+  _tkn = string_view();
+}
+
+bool TokenizerMmap::getBool(bool& b) {
+  bool success = false;
+  if(get()) {
+    if(this->equals("t") || this->equals("true") ||
+       this->equals("T") || this->equals("TRUE")) {
+      b = true;
+      success = true;
+    } else if(this->equals("f") || this->equals("false") ||
+              this->equals("F") || this->equals("FALSE")) {
+      b = false;
+      success = true;
+    }
+  }
+  return success;
+}
+
+bool TokenizerMmap::getInt(int& i) {
+  return get() && toInt(i);
+}
+
+bool TokenizerMmap::getUInt(unsigned int& ui) {
+  return get() && toUInt(ui);
+}
+
+bool TokenizerMmap::getFloat(float& f) {
+  return get() && toFloat(f);
+}
+
+bool TokenizerMmap::getColor(Color& c) {
+  return
+    getFloat(c.r) && getFloat(c.g) && getFloat(c.b);
+}
+
+bool TokenizerMmap::getVec4f(Vec4f& v) {
+  return
+    getFloat(v.x) && getFloat(v.y) && getFloat(v.z) && getFloat(v.w);
+}
+
+bool TokenizerMmap::getVec3f(Vec3f& v) {
+  return
+    getFloat(v.x) && getFloat(v.y) && getFloat(v.z);
+}
+
+bool TokenizerMmap::getVec2f(Vec2f& v) {
+  return
+    getFloat(v.x) && getFloat(v.y);
+}
+
+bool TokenizerMmap::equals(const char* str) const {
+  return _tkn==str;
+}
+
+bool TokenizerMmap::expecting(const string& str) {
+  return get() && _tkn==str;
+}
+
+bool TokenizerMmap::expecting(const char* str) {
+  return get() && _tkn==str;
+}
+
+bool TokenizerMmap::toInt(int& i) const {
+  return toInt(_tkn.data(),_tkn.data()+_tkn.length(),i);
+}
+
+bool TokenizerMmap::toUInt(unsigned int& ui) const {
+  return toUInt(_tkn.data(),_tkn.data()+_tkn.length(),ui);
+}
+
+bool TokenizerMmap::toFloat(float& f) const {
+  return toFloat(_tkn.data(),_tkn.data()+_tkn.length(),f);
+}
+
+// std::from_chars does not accept a leading '+', which sscanf does
+
+bool TokenizerMmap::toInt(const char* first, const char* last, int& i) {
+  if(first<last && *first=='+') first++;
+  return std::from_chars(first,last,i).ec==std::errc();
+}
+
+bool TokenizerMmap::toInt64(const char* first, const char* last, int64_t& i) {
+  if(first<last && *first=='+') first++;
+  return std::from_chars(first,last,i).ec==std::errc();
+}
+
+bool TokenizerMmap::toUInt
+(const char* first, const char* last, unsigned int& ui) {
+  if(first<last && *first=='+') first++;
+  return std::from_chars(first,last,ui).ec==std::errc();
+}
+
+// Exact powers of ten, used by the fast path of toFloat()
+static const double _pow10[23] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Decimal numbers with at most 18 significant digits and small
+// exponents are converted with a single double precision operation,
+// which is correctly rounded (Clinger's fast path); rounding the
+// result to float is also correct unless it falls exactly half way
+// between two floats. Everything else is handled by from_chars, so
+// the result is always the correctly rounded float, as for sscanf.
+
+bool TokenizerMmap::toFloat(const char* first, const char* last, float& f) {
+  const char* p    = first;
+  bool        neg  = false;
+  uint64_t    m    = 0;
+  int         e    = 0;
+  bool        fast = true;
+  if(p<last && (*p=='+' || *p=='-')) neg = (*p++=='-');
+  const char* d0 = p;
+  for(;p<last && (unsigned)(*p-'0')<10;p++) {
+    if(m<100000000000000000ull) m = 10*m+(uint64_t)(*p-'0');
+    else fast = false;
+  }
+  bool digits = (p>d0);
+  if(p<last && *p=='.') {
+    const char* d1 = ++p;
+    for(;p<last && (unsigned)(*p-'0')<10;p++) {
+      if(m<100000000000000000ull) { m = 10*m+(uint64_t)(*p-'0'); e--; }
+      else fast = false;
+    }
+    digits = digits || (p>d1);
+  }
+  if(digits && p<last && (*p=='e' || *p=='E')) {
+    const char* q = p+1;
+    bool eNeg = false;
+    if(q<last && (*q=='+' || *q=='-')) eNeg = (*q++=='-');
+    if(q<last && (unsigned)(*q-'0')<10) {
+      int x = 0;
+      for(;q<last && (unsigned)(*q-'0')<10;q++)
+        if(x<10000) x = 10*x+(*q-'0');
+      e += (eNeg)?-x:x;
+    }
+  }
+  if(digits && fast) {
+    if(m==0) {
+      f = (neg)?-0.0f:0.0f;
+      return true;
+    }
+    if(m<=(1ull<<53) && e>=-22 && e<=22) {
+      double d = (double)m;
+      d = (e<0)?d/_pow10[-e]:d*_pow10[e];
+      uint64_t bits;
+      memcpy(&bits,&d,sizeof(bits));
+      if((bits&0x1fffffffull)!=0x10000000ull) {
+        f = (float)((neg)?-d:d);
+        return true;
+      }
+    }
+  }
+  if(first<last && *first=='+') first++;
+  std::from_chars_result r = std::from_chars(first,last,f);
+  if(r.ec==std::errc::result_out_of_range) {
+    // sscanf returns the underflowed or overflowed value here
+    string s(first,r.ptr);
+    f = strtof(s.c_str(),(char**)0);
+    return true;
+  }
+  return r.ec==std::errc();
+}
+
+const char* TokenizerMmap::findArrayEnd() const {
+  const char* p   = _pos;
+  const char* end = _end;
+  const char* q;
+  while(p<end && (q=(const char*)memchr(p,']',(size_t)(end-p)))!=(const char*)0) {
+    p = q+1;
+    // the "]" has to be a token by itself
+    if(q>_pos && !_isBlank(q[-1])) continue;
+    if(q+1<end && !_isBlank(q[1])) continue;
+    // and not be part of a comment; comments end at the end of the
+    // line, and the current position is never within a comment
+    const char* t = q;
+    while(t>_pos && t[-1]!='\n') t--;
+    bool comment = false;
+    for(;t<q && comment==false;t++)
+      comment = (*t=='#' && (t==_pos || _isBlank(t[-1])));
+    if(comment==false) return q;
+  }
+  return (const char*)0;
+}
+
+size_t TokenizerMmap::countValues(const char* begin, const char* end) {
+  size_t n = 0;
+  const char* p = begin;
+  for(;;) {
+    while(p<end && _isBlank(*p)) p++;
+    if(p==end) break;
+    if(*p=='#') {
+      while(p<end && *p!='\n') p++;
+    } else {
+      n++;
+      while(p<end && !_isBlank(*p)) p++;
+    }
+  }
+  return n;
+}
+
+bool TokenizerMmap::parseValues
+(const char* begin, const char* end, float* value) {
+  const char* p = begin;
+  const char* t;
+  for(;;) {
+    while(p<end && _isBlank(*p)) p++;
+    if(p==end) break;
+    if(*p=='#') {
+      while(p<end && *p!='\n') p++;
+    } else {
+      t = p;
+      while(p<end && !_isBlank(*p)) p++;
+      if(toFloat(t,p,*value++)==false) return false;
+    }
+  }
+  return true;
+}
+
+bool TokenizerMmap::parseValues
+(const char* begin, const char* end, int* value) {
+  const char* p = begin;
+  const char* t;
+  for(;;) {
+    while(p<end && _isBlank(*p)) p++;
+    if(p==end) break;
+    if(*p=='#') {
+      while(p<end && *p!='\n') p++;
+    } else {
+      t = p;
+      while(p<end && !_isBlank(*p)) p++;
+      if(toInt(t,p,*value++)==false) return false;
+    }
+  }
+  return true;
+}
+
+bool TokenizerMmap::parseValues
+(const char* begin, const char* end, int64_t* value) {
+  const char* p = begin;
+  const char* t;
+  for(;;) {
+    while(p<end && _isBlank(*p)) p++;
+    if(p==end) break;
+    if(*p=='#') {
+      while(p<end && *p!='\n') p++;
+    } else {
+      t = p;
+      while(p<end && !_isBlank(*p)) p++;
+      if(toInt64(t,p,*value++)==false) return false;
+    }
+  }
+  return true;
+}
+
+// arrays spanning fewer bytes are parsed on the calling thread
+static size_t _parallelThreshold = 1<<20;
+
+size_t TokenizerMmap::getParallelThreshold() {
+  return _parallelThreshold;
+}
+
+void TokenizerMmap::setParallelThreshold(const size_t nBytes) {
+  _parallelThreshold = nBytes;
+}
+
+// Splits [begin,end) into ranges of about step bytes, which can be
+// counted and parsed independently of each other. If the range
+// contains comments the cuts are made after line breaks, since
+// comments end at the end of the line; otherwise they can be made
+// after any separator.
+
+static void _splitRange
+(const char* begin, const char* end, size_t step,
+ vector<const char*>& cut) {
+  bool comments = (memchr(begin,'#',(size_t)(end-begin))!=(void*)0);
+  cut.clear();
+  cut.push_back(begin);
+  const char* p = begin;
+  for(size_t i=1;i*step<(size_t)(end-begin);i++) {
+    if(p<begin+i*step) p = begin+i*step;
+    if(comments) {
+      while(p<end && p[-1]!='\n') p++;
+    } else {
+      while(p<end && !_isBlank(p[-1])) p++;
+    }
+    if(p>=end) break;
+    cut.push_back(p);
+  }
+  cut.push_back(end);
+}
+
+// Large arrays are split into chunks; the values in each chunk are
+// first counted in parallel, to determine where each chunk has to
+// store its values, and then parsed in parallel directly into the
+// vector, so that the result is identical to parsing them serially.
+// The counts are known before the vector is chosen and resized.
+
+class _ValueChunks {
+  vector<const char*> _cut;
+  vector<size_t>      _offset;
+public:
+  _ValueChunks(const char* begin, const char* end) {
+    size_t n    = (size_t)(end-begin);
+    size_t step = Parallel::getGrain(n,0,_parallelThreshold);
+    if(step>=n) {
+      _cut    = { begin, end };
+      _offset = { 0, TokenizerMmap::countValues(begin,end) };
+      return;
+    }
+    _splitRange(begin,end,step,_cut);
+    size_t nChunks = _cut.size()-1;
+    _offset.assign(nChunks+1,0);
+    Parallel::forEach(nChunks,[&](size_t i) {
+      _offset[i+1] = TokenizerMmap::countValues(_cut[i],_cut[i+1]);
+    });
+    for(size_t i=0;i<nChunks;i++)
+      _offset[i+1] += _offset[i];
+  }
+  size_t size() const {
+    return _offset.back();
+  }
+  // appends the values to vec
+  template <class T>
+  bool parse(vector<T>& vec) const {
+    size_t nChunks = _cut.size()-1;
+    size_t n0      = vec.size();
+    vec.resize(n0+size());
+    T* value = vec.data()+n0;
+    if(nChunks==1)
+      return TokenizerMmap::parseValues(_cut[0],_cut[1],value);
+    vector<char> success(nChunks,1);
+    Parallel::forEach(nChunks,[&](size_t i) {
+      if(TokenizerMmap::parseValues(_cut[i],_cut[i+1],value+_offset[i])==false)
+        success[i] = 0;
+    });
+    for(size_t i=0;i<nChunks;i++)
+      if(success[i]==0) return false;
+    return true;
+  }
+};
+
+template <class T>
+static bool _getValues(const char* begin, const char* end, vector<T>& vec) {
+  return _ValueChunks(begin,end).parse(vec);
+}
+
+bool TokenizerMmap::getVecFloat(vector<float>& vec) {
+  const char* close = findArrayEnd();
+  if(close==(const char*)0) return false;
+  bool success = _getValues(_pos,close,vec);
+  setPosition(close);
+  get(); // "]"
+  return success;
+}
+
+bool TokenizerMmap::getVecInt(vector<int>& vec) {
+  const char* close = findArrayEnd();
+  if(close==(const char*)0) return false;
+  bool success = _getValues(_pos,close,vec);
+  setPosition(close);
+  get(); // "]"
+  return success;
+}
+
+bool TokenizerMmap::getVecInt64(vector<int64_t>& vec) {
+  const char* close = findArrayEnd();
+  if(close==(const char*)0) return false;
+  bool success = _getValues(_pos,close,vec);
+  setPosition(close);
+  get(); // "]"
+  return success;
+}
+
+bool TokenizerMmap::getVecInt
+(vector<int>& vec, vector<int64_t>& vec64, const size_t maxSize) {
+  const char* close = findArrayEnd();
+  if(close==(const char*)0) return false;
+  _ValueChunks chunks(_pos,close);
+  bool success = false;
+  if(vec64.size()==0 && vec.size()+chunks.size()<=maxSize) {
+    size_t n0 = vec.size();
+    success = chunks.parse(vec);
+    // values which do not fit in 32 bits are parsed again below
+    if(success==false) vec.resize(n0);
+  }
+  if(success==false) {
+    vec64.insert(vec64.end(),vec.begin(),vec.end());
+    vector<int>().swap(vec);
+    success = chunks.parse(vec64);
+  }
+  setPosition(close);
+  get(); // "]"
+  return success;
+}
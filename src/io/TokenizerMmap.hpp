@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// TokenizerMmap.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef TOKENIZER_MMAP_HPP
+#define TOKENIZER_MMAP_HPP
+
+#include <string>
+#include <string_view>
+#include <stdint.h>
+#include <vector>
+#include <wrl/Node.hpp>
+#include "FileMap.hpp"
+
+using namespace std;
+
+// Tokenizer over a memory mapped file, or over a range of memory
+// owned by the caller. It splits the input with the same rules as
+// Tokenizer::get(), i.e., tokens are separated by blank space and
+// commas, and tokens starting with '#' extend to the end of the line,
+// but it does not copy characters: the current token is a string_view
+// into the mapped region, which remains valid while the TokenizerMmap
+// exists.
+
+class TokenizerMmap {
+
+private:
+
+  FileMap     _map;
+  const char* _begin;
+  const char* _end;
+  const char* _pos;
+  string_view _tkn;
+  bool        _skip; // if(_skip) skip comments
+
+public:
+
+  TokenizerMmap(const char* filename);
+  TokenizerMmap(const char* begin, const char* end);
+
+  // false if the file could not be mapped
+  bool isOpen() const;
+
+  const char*        getBegin()    const { return _begin; }
+  const char*        getEnd()      const { return _end;   }
+  const char*        getPosition() const { return _pos;   }
+  void               setPosition(const char* pos);
+
+  // current token
+  const string_view& token()  const { return _tkn;          }
+  const char*        data()   const { return _tkn.data();   }
+  size_t             length() const { return _tkn.length(); }
+  string             str()    const { return string(_tkn);  }
+
+  bool get();
+  void get(const string& errMsg);
+  bool getline();
+  void nextline();
+  bool getBool(bool& b);
+  bool getInt(int& i);
+  bool getUInt(unsigned int& ui);
+  bool getFloat(float& f);
+  bool getColor(Color& c);
+  bool getVec3f(Vec3f& v);
+  bool getVec4f(Vec4f& v);
+  bool getVec2f(Vec2f& v);
+  bool equals(const char* str) const;
+  bool expecting(const string& str);
+  bool expecting(const char* str);
+  void setSkipComments(const bool value);
+
+  // Bulk parsing of the values of MFFloat and MFInt32 fields. The
+  // current position should be right after the opening "[" token.
+  // The values are appended to vec, which is resized once, and the
+  // position is left after the closing "]" token. Comments within
+  // the brackets are skipped. Returns false if the closing "]" is
+  // missing, or if a value cannot be converted. Arrays larger than
+  // getParallelThreshold() bytes are parsed using all the threads
+  // available to the Parallel class.
+  bool getVecFloat(vector<float>& vec);
+  bool getVecInt(vector<int>& vec);
+  bool getVecInt64(vector<int64_t>& vec);
+  // for index arrays which may not fit in 32 bits: the values are
+  // appended to vec if the result has at most maxSize values, all of
+  // which fit in an int, and otherwise to vec64, to which the values
+  // of vec are moved; the values are counted before either vector is
+  // resized, and parsed only once unless one does not fit in an int
+  bool getVecInt(vector<int>& vec, vector<int64_t>& vec64, const size_t maxSize);
+
+  static size_t getParallelThreshold();
+  static void   setParallelThreshold(const size_t nBytes);
+
+  // Returns the position of the "]" token which closes the array
+  // starting at the current position, or 0 if not found.
+  const char* findArrayEnd() const;
+
+  // The following methods operate on ranges containing only values,
+  // separators, and comments. The parseValues() methods store as
+  // many values as counted by countValues() on the same range.
+  static size_t countValues(const char* begin, const char* end);
+  static bool   parseValues(const char* begin, const char* end, float* value);
+  static bool   parseValues(const char* begin, const char* end, int* value);
+  static bool   parseValues(const char* begin, const char* end, int64_t* value);
+
+  // convert the current token; as sscanf, these methods succeed if
+  // a prefix of the token can be converted
+  bool toInt(int& i) const;
+  bool toUInt(unsigned int& ui) const;
+  bool toFloat(float& f) const;
+
+  static bool toInt(const char* first, const char* last, int& i);
+  static bool toInt64(const char* first, const char* last, int64_t& i);
+  static bool toUInt(const char* first, const char* last, unsigned int& ui);
+  static bool toFloat(const char* first, const char* last, float& f);
+
+private:
+
+  TokenizerMmap(const TokenizerMmap&);
+  TokenizerMmap& operator=(const TokenizerMmap&);
+
+};
+
+#endif // TOKENIZER_MMAP_HPP
@@ -34,34 +34,78 @@
 
 #include <string>
 #include <iostream>
+#include <stdlib.h>
+#include <chrono>
+#include <sys/stat.h>
 
 using namespace std;
 
 #include <wrl/SceneGraph.hpp>
+#include <wrl/Shape.hpp>
+#include <wrl/IndexedFaceSet.hpp>
+#include <core/Faces.hpp>
+#include <core/FaceIteration.hpp>
+#include <core/TriangleNormals.hpp>
+#include <wrl/SceneGraphProcessor.hpp>
 #include <io/AppLoader.hpp>
 #include <io/AppSaver.hpp>
+#include <io/LoaderSgb.hpp>
 #include <io/LoaderStl.hpp>
 #include <io/LoaderWrl.hpp>
 #include <io/SaverWrl.hpp>
 #include <io/SaverStl.hpp>
+#include <io/SaverSgb.hpp>
+#include <util/Parallel.hpp>
 
 class Data {
 public:
   bool   _debug;
+  bool   _time;
+  bool   _weld;
+  bool   _faces;
+  bool   _normals;
+  bool   _analyze;
+  bool   _split;
+  float  _epsilon;
+  int    _threads;
+  SaverStl::Format _stlFormat;
   string _inFile;
   string _outFile;
 public:
   Data():
     _debug(false),
+    _time(false),
+    _weld(false),
+    _faces(false),
+    _normals(false),
+    _analyze(false),
+    _split(false),
+    _epsilon(0.0f),
+    _threads(0),
+    _stlFormat(SaverStl::AUTO),
     _inFile(""),
     _outFile("")
   { }
 };
 
 const char* tv(bool value)        { return (value)?"true":"false";                 }
+const char* tf(SaverStl::Format f) {
+  return (f==SaverStl::ASCII)?"ASCII":(f==SaverStl::BINARY)?"BINARY":"AUTO";
+}
 
 void options(Data& D) {
   cerr << "   -d|-debug               [" << tv(D._debug)          << "]" << endl;
+  cerr << "   -t|-time                [" << tv(D._time)           << "]" << endl;
+  cerr << "   -w|-weld                [" << tv(D._weld)           << "]" << endl;
+  cerr << "   -f|-faces               [" << tv(D._faces)          << "]" << endl;
+  cerr << "   -n|-normals             [" << tv(D._normals)        << "]" << endl;
+  cerr << "   -k|-kernel    name      ["
+       << TriangleNormals::getKernelName(TriangleNormals::getKernel()) << "]" << endl;
+  cerr << "   -m|-manifold            [" << tv(D._analyze)        << "]" << endl;
+  cerr << "   -c|-components          [" << tv(D._split)          << "]" << endl;
+  cerr << "   -e|-epsilon   value     [" << D._epsilon            << "]" << endl;
+  cerr << "   -j|-threads   n         [" << Parallel::getNumberOfThreads() << "]" << endl;
+  cerr << "   -a|-ascii|-b|-binary    [" << tf(D._stlFormat)      << "]" << endl;
 }
 
 void usage(Data& D) {
@@ -72,6 +116,154 @@ void usage(Data& D) {
   exit(0);
 }
 
+// wall clock timer used to report loading and saving speeds
+class Timer {
+  chrono::steady_clock::time_point _start;
+public:
+  Timer(): _start(chrono::steady_clock::now()) { }
+  double seconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now()-_start).count();
+  }
+};
+
+double fileSizeMB(const string& fileName) {
+  struct stat st;
+  return (stat(fileName.c_str(),&st)==0)?((double)st.st_size)/(1024.0*1024.0):0.0;
+}
+
+void report(const char* what, const string& fileName, double seconds) {
+  double mb = fileSizeMB(fileName);
+  cerr << "  " << what << " \"" << fileName << "\" : "
+       << seconds << " s, " << mb << " MB";
+  if(seconds>0.0) cerr << ", " << (mb/seconds) << " MB/s";
+  cerr << endl;
+}
+
+void collectFaceSets(Node* node, vector<IndexedFaceSet*>& ifsList) {
+  if(node==(Node*)0) return;
+  if(node->isGroup()) {
+    Group* group = (Group*)node;
+    for(int i=0;i<group->getNumberOfChildren();i++)
+      collectFaceSets((*group)[i],ifsList);
+  } else if(node->isShape()) {
+    Node* geometry = ((Shape*)node)->getGeometry();
+    if(geometry!=(Node*)0 && geometry->isIndexedFaceSet())
+      ifsList.push_back((IndexedFaceSet*)geometry);
+  }
+}
+
+// times the Faces constructor, and one sweep of each accessor over
+// all the faces or corners of every IndexedFaceSet
+void benchFaces(SceneGraph& wrl) {
+  vector<IndexedFaceSet*> ifsList;
+  collectFaceSets(&wrl,ifsList);
+  for(IndexedFaceSet* ifs : ifsList) {
+    Timer buildTimer;
+    const vector<int>& coordIndex = ifs->getCoordIndex();
+    Faces faces(ifs->getNumberOfCoord(),(int)coordIndex.size(),coordIndex.data());
+    double buildSeconds = buildTimer.seconds();
+    int nF = faces.getNumberOfFaces();
+    int nC = faces.getNumberOfCorners();
+    cerr << "  faces : nV = " << faces.getNumberOfVertices()
+         << ", nF = " << nF << ", nC = " << nC << endl;
+    cerr << "    constructor        : " << buildSeconds << " s" << endl;
+    long long sum = 0;
+    auto sweep = [&sum](const char* name, int n, auto f) {
+      Timer timer;
+      for(int i=0;i<n;i++) sum += f(i);
+      double seconds = timer.seconds();
+      cerr << "    " << name << " : " << seconds << " s";
+      if(n>0) cerr << ", " << (1.0e9*seconds/n) << " ns/call";
+      cerr << endl;
+    };
+    sweep("getFaceSize       ",nF,[&](int iF){return faces.getFaceSize(iF);});
+    sweep("getFaceFirstCorner",nF,[&](int iF){return faces.getFaceFirstCorner(iF);});
+    sweep("getFaceVertex     ",nF,[&](int iF){return faces.getFaceVertex(iF,0);});
+    sweep("getCornerFace     ",nC,[&](int iC){return faces.getCornerFace(iC);});
+    sweep("getNextCorner     ",nC,[&](int iC){return faces.getNextCorner(iC);});
+    // fan triangulation through the accessors, and through the
+    // header-only loops
+    long long sumAccessors = 0, sumLoops = 0;
+    Timer accessorTimer;
+    for(int iF=0;iF<nF;iF++) {
+      int n = faces.getFaceSize(iF);
+      for(int k=2;k<n;k++)
+        sumAccessors += faces.getFaceVertex(iF,0)+
+          faces.getFaceVertex(iF,k-1)+faces.getFaceVertex(iF,k);
+    }
+    cerr << "    triangles accessors: " << accessorTimer.seconds() << " s" << endl;
+    Timer loopTimer;
+    forEachTriangle(coordIndex,[&](int, int iC0, int iC1, int iC2) {
+      sumLoops += coordIndex[iC0]+coordIndex[iC1]+coordIndex[iC2];
+    });
+    cerr << "    forEachTriangle    : " << loopTimer.seconds() << " s"
+         << ((sumLoops==sumAccessors)?"":" (MISMATCH)") << endl;
+    Timer twinTimer;
+    faces.buildTwinCorners();
+    cerr << "    buildTwinCorners   : " << twinTimer.seconds() << " s" << endl;
+    sweep("getTwinCorner     ",nC,[&](int iC){return faces.getTwinCorner(iC);});
+    int nBoundary = 0, nNonManifold = 0;
+    for(int iC=0;iC<nC;iC++) {
+      if(faces.isBoundaryEdge(iC))    nBoundary++;
+      if(faces.isNonManifoldEdge(iC)) nNonManifold++;
+    }
+    cerr << "    boundary corners   : " << nBoundary << endl;
+    cerr << "    non-manifold       : " << nNonManifold << endl;
+    Timer vertexTimer;
+    faces.buildVertexCorners();
+    cerr << "    buildVertexCorners : " << vertexTimer.seconds() << " s" << endl;
+    int nV = faces.getNumberOfVertices();
+    sweep("getVertexCorner   ",nV,[&](int iV){return faces.getVertexCorner(iV,0);});
+    Timer edgeTimer;
+    faces.buildEdges();
+    cerr << "    buildEdges         : " << edgeTimer.seconds() << " s, nE = "
+         << faces.getNumberOfEdges() << endl;
+    cerr << "    checksum           : " << sum << endl;
+  }
+}
+
+// times the normals per face and per vertex of every IndexedFaceSet,
+// with the best of 3 runs each; the normals loaded from the file are
+// restored afterwards
+void benchNormals(SceneGraph& wrl) {
+  vector<IndexedFaceSet*> ifsList;
+  collectFaceSets(&wrl,ifsList);
+  vector<vector<float> > normal;
+  vector<vector<int> >   normalIndex;
+  vector<bool>           normalPerVertex;
+  size_t nF = 0;
+  for(IndexedFaceSet* ifs : ifsList) {
+    normal.push_back(ifs->getNormal());
+    normalIndex.push_back(ifs->getNormalIndex());
+    normalPerVertex.push_back(ifs->getNormalPerVertex());
+    nF += (size_t)ifs->getNumberOfFaces();
+  }
+  cerr << "  normals : nF = " << nF << ", kernel = "
+       << TriangleNormals::getKernelName(TriangleNormals::getKernel())
+       << ", " << Parallel::getNumberOfThreads() << " threads" << endl;
+  SceneGraphProcessor processor(wrl);
+  auto time = [&](const char* name, void (SceneGraphProcessor::*compute)()) {
+    double best = 0.0;
+    for(int k=0;k<3;k++) {
+      processor.normalClear();
+      Timer timer;
+      (processor.*compute)();
+      double seconds = timer.seconds();
+      if(k==0 || seconds<best) best = seconds;
+    }
+    cerr << "    " << name << " : " << best << " s";
+    if(best>0.0) cerr << ", " << (1.0e-6*nF/best) << " Mfaces/s";
+    cerr << endl;
+  };
+  time("computeNormalPerFace  ",&SceneGraphProcessor::computeNormalPerFace);
+  time("computeNormalPerVertex",&SceneGraphProcessor::computeNormalPerVertex);
+  for(size_t i=0;i<ifsList.size();i++) {
+    ifsList[i]->getNormal().swap(normal[i]);
+    ifsList[i]->getNormalIndex().swap(normalIndex[i]);
+    ifsList[i]->setNormalPerVertex(normalPerVertex[i]);
+  }
+}
+
 void error(const char *msg) {
   cerr << "ERROR: dgpTest1 | " << ((msg)?msg:"") << endl;
   exit(0);
@@ -89,6 +281,41 @@ int main(int argc, char **argv) {
       usage(D);
     } else if(string(argv[i])=="-d" || string(argv[i])=="-debug") {
       D._debug = !D._debug;
+    } else if(string(argv[i])=="-t" || string(argv[i])=="-time") {
+      D._time = !D._time;
+    } else if(string(argv[i])=="-w" || string(argv[i])=="-weld") {
+      D._weld = !D._weld;
+    } else if(string(argv[i])=="-f" || string(argv[i])=="-faces") {
+      D._faces = !D._faces;
+    } else if(string(argv[i])=="-n" || string(argv[i])=="-normals") {
+      D._normals = !D._normals;
+    } else if(string(argv[i])=="-k" || string(argv[i])=="-kernel") {
+      if(++i>=argc) error("missing kernel name");
+      string kernel(argv[i]);
+      if(kernel=="scalar")
+        TriangleNormals::setKernel(TriangleNormals::SCALAR);
+      else if(kernel=="sse")
+        TriangleNormals::setKernel(TriangleNormals::SSE);
+      else if(kernel=="avx2")
+        TriangleNormals::setKernel(TriangleNormals::AVX2);
+      else
+        error("invalid kernel name, expecting scalar, sse or avx2");
+    } else if(string(argv[i])=="-m" || string(argv[i])=="-manifold") {
+      D._analyze = !D._analyze;
+    } else if(string(argv[i])=="-c" || string(argv[i])=="-components") {
+      D._split = !D._split;
+    } else if(string(argv[i])=="-a" || string(argv[i])=="-ascii") {
+      D._stlFormat = SaverStl::ASCII;
+    } else if(string(argv[i])=="-b" || string(argv[i])=="-binary") {
+      D._stlFormat = SaverStl::BINARY;
+    } else if(string(argv[i])=="-e" || string(argv[i])=="-epsilon") {
+      if(++i>=argc) error("missing epsilon value");
+      D._epsilon = (float)atof(argv[i]);
+    } else if(string(argv[i])=="-j" || string(argv[i])=="-threads") {
+      if(++i>=argc) error("missing number of threads");
+      D._threads = atoi(argv[i]);
+      if(D._threads<=0) error("invalid number of threads");
+      Parallel::setNumberOfThreads((unsigned)D._threads);
     } else if(string(argv[i])[0]=='-') {
       error("unknown option");
     } else if(D._inFile=="") {
@@ -126,13 +353,20 @@ int main(int argc, char **argv) {
   LoaderWrl* wrlLoader = new LoaderWrl();
   loaderFactory.registerLoader(wrlLoader);
   LoaderStl* stlLoader = new LoaderStl();
+  stlLoader->setWeld(D._weld);
+  stlLoader->setWeldEpsilon(D._epsilon);
   loaderFactory.registerLoader(stlLoader);
+  LoaderSgb* sgbLoader = new LoaderSgb();
+  loaderFactory.registerLoader(sgbLoader);
 
   // register output file savers  
   SaverWrl* wrlSaver = new SaverWrl();
   saverFactory.registerSaver(wrlSaver);
   SaverStl* stlSaver = new SaverStl();
+  stlSaver->setFormat(D._stlFormat);
   saverFactory.registerSaver(stlSaver);
+  SaverSgb* sgbSaver = new SaverSgb();
+  saverFactory.registerSaver(sgbSaver);
 
   // read input file and create SceneGraph /////////////////////////////
 
@@ -142,7 +376,9 @@ int main(int argc, char **argv) {
   }
 
   SceneGraph wrl; // create empty scene graph
+  Timer loadTimer;
   success = loaderFactory.load(D._inFile.c_str(),wrl);
+  if(D._time) report("load",D._inFile,loadTimer.seconds());
 
   if(D._debug) {
     cerr << "    success        = " << tv(success)          << endl;
@@ -153,6 +389,31 @@ int main(int argc, char **argv) {
   if(success==false) return -1;
 
   // process ///////////////////////////////////////////////////////////
+
+  if(D._faces) benchFaces(wrl);
+
+  if(D._normals) benchNormals(wrl);
+
+  if(D._analyze) {
+    // closed, manifold, and oriented meshes can be sent to a printer
+    Timer analysisTimer;
+    SceneGraphProcessor processor(wrl);
+    MeshAnalysis analysis = processor.analyzeMesh();
+    double seconds = analysisTimer.seconds();
+    cerr << "  mesh analysis {" << endl;
+    analysis.printInfo(cerr,"    ");
+    cerr << "    time                  = " << seconds << " s" << endl;
+    cerr << "  }" << endl;
+  }
+
+  if(D._split) {
+    // one Shape per connected component
+    Timer splitTimer;
+    SceneGraphProcessor processor(wrl);
+    int nSplit = processor.componentsSplit();
+    cerr << "  components split : " << nSplit << " shapes, "
+         << splitTimer.seconds() << " s" << endl;
+  }
   
   // if(D._debug) cerr << "  processing {" << endl;
   // if(D._debug) cerr << "    nothing to do in this assignment" << endl;
@@ -165,7 +426,9 @@ int main(int argc, char **argv) {
     cerr << "    fileName       = \"" << D._outFile << "\"" << endl;
   }
 
+  Timer saveTimer;
   success = saverFactory.save(D._outFile.c_str(),wrl);
+  if(D._time) report("save",D._outFile,saveTimer.seconds());
 
   if(D._debug) {
     cerr << "    success        = " << tv(success)          << endl;
@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// normalTest.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Checks the incremental normal updates of SceneGraphProcessor
+// against a full computation, which they must match bit for bit,
+// on meshes with and without empty faces, with one and several
+// threads. Returns the number of failed checks.
+
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+#include <wrl/SceneGraph.hpp>
+#include <wrl/Shape.hpp>
+#include <wrl/IndexedFaceSet.hpp>
+#include <wrl/SceneGraphProcessor.hpp>
+#include <core/FaceIteration.hpp>
+#include <util/Parallel.hpp>
+
+// A grid of n x n quads, split into triangles except for one quad in
+// seven, with random heights. If packed is false, the coordIndex
+// array starts with empty faces, and has a few more in the middle.
+IndexedFaceSet* makeGrid(SceneGraph& wrl, int n, bool packed) {
+  Shape*          shape = new Shape();
+  IndexedFaceSet* ifs   = new IndexedFaceSet();
+  shape->setGeometry(ifs);
+  wrl.addChild(shape);
+  vector<float>& coord      = ifs->getCoord();
+  vector<int>&   coordIndex = ifs->getCoordIndex();
+  srand(1);
+  for(int j=0;j<=n;j++)
+    for(int i=0;i<=n;i++) {
+      coord.push_back((float)i);
+      coord.push_back((float)j);
+      coord.push_back((float)(rand()%100)/50.0f);
+    }
+  if(packed==false)
+    coordIndex.insert(coordIndex.end(),10,-1);
+  for(int j=0;j<n;j++)
+    for(int i=0;i<n;i++) {
+      int iV00 = j*(n+1)+i, iV10 = iV00+1, iV01 = iV00+n+1, iV11 = iV01+1;
+      if((i+j)%7==0) {
+        coordIndex.insert(coordIndex.end(),{iV00,iV10,iV11,iV01,-1});
+      } else {
+        coordIndex.insert(coordIndex.end(),{iV00,iV10,iV11,-1});
+        coordIndex.insert(coordIndex.end(),{iV00,iV11,iV01,-1});
+      }
+      if(packed==false && i==0 && j%5==0)
+        coordIndex.push_back(-1);
+    }
+  return ifs;
+}
+
+int nFailed = 0;
+
+void check(const char* what, IndexedFaceSet& ifs, IndexedFaceSet& ref) {
+  bool ok = (ifs.getNormal()==ref.getNormal() &&
+             ifs.getNormalPerVertex()==ref.getNormalPerVertex());
+  if(ok==false) nFailed++;
+  cerr << "  " << what << " : " << ((ok)?"ok":"FAILED") << endl;
+}
+
+void computeNormal(SceneGraphProcessor& processor, bool perVertex) {
+  if(perVertex)
+    processor.computeNormalPerVertex();
+  else
+    processor.computeNormalPerFace();
+}
+
+// Moves a few vertices, and updates the normals through both
+// methods; the faces passed to normalUpdateFaces() are numbered as in
+// the IndexedFaceSet, counting the empty faces.
+void testMove(int n, bool packed, bool perVertex) {
+  SceneGraph wrl,wrlRef;
+  IndexedFaceSet& ifs    = *makeGrid(wrl,n,packed);
+  IndexedFaceSet& ifsRef = *makeGrid(wrlRef,n,packed);
+  SceneGraphProcessor processor(wrl),processorRef(wrlRef);
+  computeNormal(processor,perVertex);
+  vector<int> vertex;
+  for(int iV=n/2;iV<ifs.getNumberOfCoord();iV+=n+7)
+    vertex.push_back(iV);
+  vector<float>& coord = ifs.getCoord();
+  for(int iV : vertex)
+    coord[3*iV+2] += 0.75f;
+  ifsRef.getCoord() = coord;
+  computeNormal(processorRef,perVertex);
+
+  processor.normalUpdateVertices(ifs,vertex);
+  check("normalUpdateVertices",ifs,ifsRef);
+
+  for(int iV : vertex)
+    coord[3*iV+2] -= 0.75f;
+  ifsRef.getCoord() = coord;
+  processorRef.normalClear();
+  computeNormal(processorRef,perVertex);
+  vector<int> face;
+  const vector<int>& coordIndex = ifs.getCoordIndex();
+  forEachFace(coordIndex,[&](int iF, int i0, int i1) {
+    for(int i=i0;i<i1;i++)
+      if(coordIndex[i]%(n+7)==n/2%(n+7)) { face.push_back(iF); break; }
+  });
+  processor.normalUpdateFaces(ifs,face);
+  check("normalUpdateFaces   ",ifs,ifsRef);
+}
+
+// Overwrites the normals of one face in k, or of their vertices, and
+// restores them with normalUpdateFaces(); large enough meshes take
+// the parallel paths.
+void testRestore(int n, int k, bool perVertex) {
+  SceneGraph wrl,wrlRef;
+  IndexedFaceSet& ifs    = *makeGrid(wrl,n,true);
+  IndexedFaceSet& ifsRef = *makeGrid(wrlRef,n,true);
+  SceneGraphProcessor processor(wrl),processorRef(wrlRef);
+  computeNormal(processor,perVertex);
+  computeNormal(processorRef,perVertex);
+  vector<float>& normal     = ifs.getNormal();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  vector<int> face;
+  forEachFace(coordIndex,[&](int iF, int i0, int i1) {
+    if(iF%k!=0) return;
+    face.push_back(iF);
+    for(int i=i0;i<i1;i++) {
+      size_t iN = 3*(size_t)((perVertex)?coordIndex[i]:iF);
+      normal[iN] = normal[iN+1] = normal[iN+2] = 0.0f;
+    }
+  });
+  processor.normalUpdateFaces(ifs,face);
+  check("normalUpdateFaces   ",ifs,ifsRef);
+}
+
+int main(int /*argc*/, char** /*argv*/) {
+  for(int nThreads : {1,4}) {
+    Parallel::setNumberOfThreads(nThreads);
+    for(bool perVertex : {false,true}) {
+      const char* binding = (perVertex)?"per vertex":"per face";
+      cerr << nThreads << " threads, normals " << binding << ", packed" << endl;
+      testMove(100,true,perVertex);
+      cerr << nThreads << " threads, normals " << binding << ", empty faces" << endl;
+      testMove(100,false,perVertex);
+      cerr << nThreads << " threads, normals " << binding << ", restored" << endl;
+      testRestore(800,17,perVertex);
+      testRestore(800,3,perVertex);
+    }
+  }
+  cerr << ((nFailed==0)?"passed":"FAILED") << endl;
+  return nFailed;
+}
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// parallelBench.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures how the loops and the task groups of util/Parallel.hpp
+// scale with the number of threads: the cost of dispatching empty
+// loops, a compute bound and a memory bound forRange() loop, and a
+// recursive computation on task groups.
+//
+// USAGE: parallelBench [maxThreads [n]]
+
+#include <iostream>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+#include <util/Parallel.hpp>
+
+class Timer {
+  chrono::steady_clock::time_point _start;
+public:
+  Timer(): _start(chrono::steady_clock::now()) { }
+  double seconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now()-_start).count();
+  }
+};
+
+long fib(int n) {
+  if(n<20) return (n<2)?n:fib(n-1)+fib(n-2);
+  long x = 0, y = 0;
+  Parallel::TaskGroup group;
+  group.run([&x,n]() { x = fib(n-1); });
+  y = fib(n-2);
+  group.wait();
+  return x+y;
+}
+
+int main(int argc, char** argv) {
+  unsigned maxThreads = (argc>1)?(unsigned)atoi(argv[1]):0;
+  size_t   n          = (argc>2)?(size_t)atol(argv[2]):(1<<26);
+  if(maxThreads==0) maxThreads = Parallel::getNumberOfThreads();
+  vector<float> x(n,1.0f),y(n,0.0f);
+  double base[4] = { 0.0, 0.0, 0.0, 0.0 };
+  cerr << "threads\tdispatch (us)\tcompute (s)\tmemory (s)\ttasks (s)" << endl;
+  for(unsigned nThreads=1;nThreads<=maxThreads;nThreads*=2) {
+    Parallel::setNumberOfThreads(nThreads);
+    Parallel::forEach(nThreads,[](size_t) { }); // starts the pool
+    double t[4];
+    Timer dispatchTimer;
+    for(int k=0;k<1000;k++)
+      Parallel::forEach(nThreads,[](size_t) { });
+    t[0] = 1000.0*dispatchTimer.seconds();
+    Timer computeTimer;
+    double s = Parallel::reduce(n,0,0.0,[](size_t i0, size_t i1) {
+      double si = 0.0;
+      for(size_t i=i0;i<i1;i++) si += sqrt((double)i);
+      return si;
+    },[](double a, double b) { return a+b; });
+    t[1] = computeTimer.seconds();
+    Timer memoryTimer;
+    Parallel::forRange(n,0,[&](size_t i0, size_t i1) {
+      for(size_t i=i0;i<i1;i++) y[i] += 2.0f*x[i];
+    });
+    t[2] = memoryTimer.seconds();
+    Timer taskTimer;
+    long f = fib(36);
+    t[3] = taskTimer.seconds();
+    if(nThreads==1)
+      for(int j=0;j<4;j++) base[j] = t[j];
+    cerr << "  " << nThreads;
+    for(int j=0;j<4;j++)
+      cerr << "\t" << t[j] << " (x" << ((t[j]>0.0)?base[j]/t[j]:0.0) << ")";
+    cerr << ((s>0.0 && f>0)?"":" ?") << endl;
+  }
+  return 0;
+}
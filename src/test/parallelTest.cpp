@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// parallelTest.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Checks the loops and the task groups of util/Parallel.hpp, with
+// several numbers of threads. Returns the number of failed checks.
+
+#include <iostream>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+#include <util/Parallel.hpp>
+
+int nFailed = 0;
+
+void check(const char* what, bool ok) {
+  if(ok==false) {
+    nFailed++;
+    cerr << "  " << what << " : FAILED" << endl;
+  }
+}
+
+// each index is visited exactly once
+void testForEach() {
+  for(size_t n : {0,1,7,1000,100000}) {
+    vector<atomic<int> > count(n);
+    for(auto& c : count) c = 0;
+    Parallel::forEach(n,[&](size_t i) { count[i]++; });
+    bool ok = true;
+    for(auto& c : count) if(c!=1) ok = false;
+    check("forEach exactly once",ok);
+  }
+}
+
+// the blocks cover the range exactly once, and have the requested
+// size, except for the last one
+void testForRange() {
+  const size_t n = 10007;
+  for(size_t grain : {0,1,3,1000,20000}) {
+    vector<atomic<int> > count(n);
+    for(auto& c : count) c = 0;
+    atomic<bool> sizes(true);
+    size_t g = Parallel::getGrain(n,grain);
+    Parallel::forRange(n,grain,[&](size_t i0, size_t i1) {
+      if(i0%g!=0 || (i1-i0!=g && i1!=n)) sizes = false;
+      for(size_t i=i0;i<i1;i++) count[i]++;
+    });
+    bool ok = true;
+    for(auto& c : count) if(c!=1) ok = false;
+    check("forRange exactly once",ok);
+    check("forRange block sizes",sizes);
+    vector<size_t> cut;
+    size_t nB = Parallel::split(n,grain,cut);
+    check("split",cut.size()==nB+1 && cut[0]==0 && cut[nB]==n &&
+          cut[1]==((g<n)?g:n));
+  }
+  check("getGrain serial",Parallel::getGrain(1000,0,1001)==1000);
+}
+
+// loops nested in the tasks of other loops run to completion
+void testNested() {
+  atomic<long> sum(0);
+  Parallel::forEach(16,[&](size_t i) {
+    Parallel::forRange(100,7,[&](size_t j0, size_t j1) {
+      for(size_t j=j0;j<j1;j++) sum += (long)(100*i+j);
+    });
+  });
+  check("nested loops",sum==1600L*1599/2);
+}
+
+long fib(int n) {
+  if(n<18) {
+    long a = 0, b = 1;
+    for(int i=0;i<n;i++) { long c = a+b; a = b; b = c; }
+    return a;
+  }
+  long x = 0, y = 0;
+  Parallel::TaskGroup group;
+  group.run([&x,n]() { x = fib(n-1); });
+  y = fib(n-2);
+  group.wait();
+  return x+y;
+}
+
+// recursive task groups, a group reused after wait(), and a group
+// waited for by its destructor
+void testTaskGroup() {
+  check("TaskGroup recursion",fib(30)==832040);
+  atomic<int> count(0);
+  {
+    Parallel::TaskGroup group;
+    for(int k=0;k<100;k++) group.run([&count]() { count++; });
+    group.wait();
+    check("TaskGroup wait",count==100);
+    for(int k=0;k<100;k++) group.run([&count]() { count++; });
+  }
+  check("TaskGroup destructor",count==200);
+}
+
+// with a fixed grain, the result does not depend on the number of
+// threads; bool values are written by concurrent blocks
+double reduceSum() {
+  return Parallel::reduce(1000000,1000,0.0,[](size_t i0, size_t i1) {
+    double s = 0.0;
+    for(size_t i=i0;i<i1;i++) s += 1.0/(double)(i+1);
+    return s;
+  },[](double a, double b) { return a+b; });
+}
+
+void testReduce(double sum1) {
+  check("reduce deterministic",reduceSum()==sum1);
+  for(size_t grain : {1,2,5}) {
+    bool all = Parallel::reduce(100000,grain,true,[](size_t i0, size_t i1) {
+      return i1>i0;
+    },[](bool a, bool b) { return a && b; });
+    check("reduce bool",all);
+  }
+  long count = Parallel::reduce(0,0,(long)0,[](size_t i0, size_t i1) {
+    return (long)(i1-i0);
+  },[](long a, long b) { return a+b; });
+  check("reduce empty",count==0);
+}
+
+int main(int /*argc*/, char** /*argv*/) {
+  Parallel::setNumberOfThreads(1);
+  double sum1 = reduceSum();
+  for(unsigned nThreads : {1,2,3,4,8}) {
+    Parallel::setNumberOfThreads(nThreads);
+    cerr << nThreads << " threads" << endl;
+    testForEach();
+    testForRange();
+    testNested();
+    testTaskGroup();
+    testReduce(sum1);
+  }
+  Parallel::setNumberOfThreads(0);
+  cerr << ((nFailed==0)?"passed":"FAILED") << endl;
+  return nFailed;
+}
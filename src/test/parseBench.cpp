@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// parseBench.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+// Measures the speed of TokenizerMmap, in MB/s of input, parsing a
+// synthetic MFFloat array of n values held in memory into a
+// vector<float>, in two ways: one token at a time, with get() and
+// toFloat(), as the loaders used to do, and with getVecFloat(). The
+// two results are checked to be identical.
+//
+// USAGE: parseBench [n]
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <util/Parallel.hpp>
+#include <io/TokenizerMmap.hpp>
+
+class Timer {
+  chrono::steady_clock::time_point _start;
+public:
+  Timer(): _start(chrono::steady_clock::now()) { }
+  double seconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now()-_start).count();
+  }
+};
+
+// "[ x y z\n x y z\n ... ]", three values per line, as SaverWrl
+// writes the coordinates of the vertices
+void makeArray(string& text, const size_t n) {
+  char buf[32];
+  text.reserve(12*n+16);
+  text = "[\n";
+  srand(1);
+  for(size_t i=0;i<n;i++) {
+    float x = (float)rand()/(float)RAND_MAX*200.0f-100.0f;
+    snprintf(buf,sizeof(buf),(i%3==2)?"%.4f\n":"%.4f ",x);
+    text += buf;
+  }
+  text += "]\n";
+}
+
+bool parseByToken(TokenizerMmap& tkmm, vector<float>& vec) {
+  float f;
+  if(tkmm.expecting("[")==false) return false;
+  while(tkmm.get()) {
+    if(tkmm.equals("]")) return true;
+    if(tkmm.toFloat(f)==false) return false;
+    vec.push_back(f);
+  }
+  return false;
+}
+
+bool parseByArray(TokenizerMmap& tkmm, vector<float>& vec) {
+  return tkmm.expecting("[") && tkmm.getVecFloat(vec);
+}
+
+int main(int argc, char** argv) {
+  size_t n = (argc>1)?(size_t)atol(argv[1]):50000000;
+  string text;
+  makeArray(text,n);
+  const char* begin = text.data();
+  const char* end   = begin+text.size();
+  double mb = (double)text.size()/(1024.0*1024.0);
+  cerr << "values  = " << n << endl;
+  cerr << "input   = " << mb << " MB" << endl;
+  cerr << "threads = " << Parallel::getNumberOfThreads() << endl;
+
+  vector<float> vecToken,vecArray;
+  TokenizerMmap tkmmToken(begin,end);
+  Timer tokenTimer;
+  bool okToken = parseByToken(tkmmToken,vecToken);
+  double tToken = tokenTimer.seconds();
+  TokenizerMmap tkmmArray(begin,end);
+  Timer arrayTimer;
+  bool okArray = parseByArray(tkmmArray,vecArray);
+  double tArray = arrayTimer.seconds();
+
+  bool same = okToken && okArray && vecToken.size()==n &&
+    vecArray.size()==n &&
+    memcmp(vecToken.data(),vecArray.data(),n*sizeof(float))==0;
+  cerr << "method\t\ttime (s)\tMB/s" << endl;
+  cerr << "  get+toFloat\t" << tToken << "\t"
+       << ((tToken>0.0)?mb/tToken:0.0) << endl;
+  cerr << "  getVecFloat\t" << tArray << "\t"
+       << ((tArray>0.0)?mb/tArray:0.0)
+       << " (x" << ((tArray>0.0)?tToken/tArray:0.0) << ")" << endl;
+  cerr << "results " << ((same)?"identical":"DIFFERENT") << endl;
+  return (same)?0:1;
+}
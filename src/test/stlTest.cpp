@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// stlTest.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Checks that triangle meshes saved by SaverStl in binary format are
+// loaded back by LoaderStl with the same bits: the coord, normal and
+// coordIndex arrays are compared with memcmp, for stored normals per
+// face, for normals computed by each TriangleNormals kernel, and for
+// meshes with 32 and 64 bit indices. Returns the number of failed
+// checks.
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+#include <wrl/SceneGraph.hpp>
+#include <wrl/Shape.hpp>
+#include <wrl/IndexedFaceSet.hpp>
+#include <core/TriangleNormals.hpp>
+#include <io/LoaderStl.hpp>
+#include <io/SaverStl.hpp>
+
+const char* fileName = "stlTest.stl";
+
+int nFailed = 0;
+
+void check(const char* what, bool ok) {
+  if(ok==false) nFailed++;
+  cerr << "  " << what << " : " << ((ok)?"ok":"FAILED") << endl;
+}
+
+template <class T>
+bool same(const vector<T>& a, const vector<T>& b) {
+  return a.size()==b.size() &&
+    (a.size()==0 || memcmp(a.data(),b.data(),a.size()*sizeof(T))==0);
+}
+
+float randomFloat() {
+  return (float)rand()/(float)RAND_MAX*200.0f-100.0f;
+}
+
+// nT triangles with three vertices of their own each, as LoaderStl
+// creates them without welding; a few triangles are degenerate
+IndexedFaceSet* makeTriangles(SceneGraph& wrl, size_t nT, bool normals) {
+  Shape*          shape = new Shape();
+  IndexedFaceSet* ifs   = new IndexedFaceSet();
+  shape->setGeometry(ifs);
+  wrl.addChild(shape);
+  vector<float>& coord      = ifs->getCoord();
+  vector<int>&   coordIndex = ifs->getCoordIndex();
+  vector<float>& normal     = ifs->getNormal();
+  srand(1);
+  for(size_t iT=0;iT<nT;iT++) {
+    for(int j=0;j<9;j++)
+      coord.push_back((iT%1000==0 && j>=3)?coord[9*iT+j%3]:randomFloat());
+    for(int j=0;j<3;j++)
+      coordIndex.push_back((int)(3*iT+j));
+    coordIndex.push_back(-1);
+  }
+  ifs->setNormalPerVertex(false);
+  if(normals)
+    for(size_t i=0;i<3*nT;i++)
+      normal.push_back(randomFloat());
+  return ifs;
+}
+
+// saves the mesh in binary format, and loads it back
+IndexedFaceSet* saveAndLoad(SceneGraph& wrl, SceneGraph& wrlLoaded) {
+  SaverStl saver;
+  saver.setFormat(SaverStl::BINARY);
+  LoaderStl loader;
+  if(saver.save(fileName,wrl)==false || loader.load(fileName,wrlLoaded)==false)
+    return (IndexedFaceSet*)0;
+  remove(fileName);
+  if(wrlLoaded.getChildren().size()!=1) return (IndexedFaceSet*)0;
+  Shape* shape = (Shape*)(wrlLoaded.getChildren()[0]);
+  return (IndexedFaceSet*)(shape->getGeometry());
+}
+
+void testRoundTrip(size_t nT, bool normals, bool wide) {
+  SceneGraph wrl,wrlLoaded;
+  IndexedFaceSet* ifs = makeTriangles(wrl,nT,normals);
+  size_t threshold = Loader::getWideIndexThreshold();
+  if(wide) {
+    vector<int>& coordIndex = ifs->getCoordIndex();
+    ifs->getCoordIndex64().assign(coordIndex.begin(),coordIndex.end());
+    coordIndex.clear();
+    Loader::setWideIndexThreshold(0);
+  }
+  // the normals SaverStl computes, with the kernel used for the
+  // index type of the mesh
+  vector<float> normal = ifs->getNormal();
+  if(normals==false) {
+    normal.resize(3*nT);
+    if(wide)
+      TriangleNormals::compute(ifs->getCoord().data(),3*nT,
+                               ifs->getCoordIndex64().data(),nT,normal.data());
+    else
+      TriangleNormals::compute(ifs->getCoord().data(),3*nT,
+                               ifs->getCoordIndex().data(),nT,normal.data());
+  }
+  IndexedFaceSet* loaded = saveAndLoad(wrl,wrlLoaded);
+  Loader::setWideIndexThreshold(threshold);
+  check("save and load",loaded!=(IndexedFaceSet*)0);
+  if(loaded==(IndexedFaceSet*)0) return;
+  check("coord",same(ifs->getCoord(),loaded->getCoord()));
+  check("normal",same(normal,loaded->getNormal()));
+  check("coordIndex",same(ifs->getCoordIndex(),loaded->getCoordIndex()) &&
+        same(ifs->getCoordIndex64(),loaded->getCoordIndex64()));
+}
+
+int main(int /*argc*/, char** /*argv*/) {
+  // more than one block of records of SaverStl
+  const size_t nT = 50001;
+  for(bool wide : {false,true}) {
+    const char* indices = (wide)?"64 bit":"32 bit";
+    cerr << "normals per face, " << indices << " indices" << endl;
+    testRoundTrip(nT,true,wide);
+    for(TriangleNormals::Kernel kernel :
+          {TriangleNormals::SCALAR,TriangleNormals::SSE,TriangleNormals::AVX2}) {
+      TriangleNormals::setKernel(kernel);
+      cerr << "normals computed by the "
+           << TriangleNormals::getKernelName(TriangleNormals::getKernel())
+           << " kernel, " << indices << " indices" << endl;
+      testRoundTrip(nT,false,wide);
+    }
+  }
+  cerr << ((nFailed==0)?"passed":"FAILED") << endl;
+  return nFailed;
+}
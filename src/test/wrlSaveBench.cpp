@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// wrlSaveBench.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+// Measures the speed of SaverWrl, in MB/s of output, on a synthetic
+// IndexedFaceSet: a grid of nFaces triangles, with coordinates and
+// normals per vertex, saved with 1,2,4,...,maxThreads threads.
+//
+// USAGE: wrlSaveBench [maxThreads [nFaces]]
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+#include <util/Parallel.hpp>
+#include <wrl/SceneGraph.hpp>
+#include <wrl/Shape.hpp>
+#include <wrl/IndexedFaceSet.hpp>
+#include <io/SaverWrl.hpp>
+
+const char* fileName = "wrlSaveBench.wrl";
+
+class Timer {
+  chrono::steady_clock::time_point _start;
+public:
+  Timer(): _start(chrono::steady_clock::now()) { }
+  double seconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now()-_start).count();
+  }
+};
+
+// a grid of nRows x nCols vertices on the unit square, two triangles
+// per cell
+void makeGrid(IndexedFaceSet& ifs, size_t nRows, size_t nCols) {
+  vector<float>& coord      = ifs.getCoord();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  vector<float>& normal     = ifs.getNormal();
+  coord.resize(3*nRows*nCols);
+  normal.resize(3*nRows*nCols);
+  for(size_t i=0;i<nRows;i++) {
+    for(size_t j=0;j<nCols;j++) {
+      size_t iV = i*nCols+j;
+      coord[3*iV  ] = (float)j/(float)(nCols-1);
+      coord[3*iV+1] = (float)i/(float)(nRows-1);
+      coord[3*iV+2] = 0.1f*(float)((i*7+j*13)%17)/17.0f;
+      normal[3*iV  ] = 0.0f;
+      normal[3*iV+1] = 0.0f;
+      normal[3*iV+2] = 1.0f;
+    }
+  }
+  coordIndex.reserve(8*(nRows-1)*(nCols-1));
+  for(size_t i=0;i+1<nRows;i++) {
+    for(size_t j=0;j+1<nCols;j++) {
+      int iV00 = (int)(i*nCols+j),   iV01 = iV00+1;
+      int iV10 = iV00+(int)nCols,    iV11 = iV10+1;
+      coordIndex.push_back(iV00);
+      coordIndex.push_back(iV01);
+      coordIndex.push_back(iV11);
+      coordIndex.push_back(-1);
+      coordIndex.push_back(iV00);
+      coordIndex.push_back(iV11);
+      coordIndex.push_back(iV10);
+      coordIndex.push_back(-1);
+    }
+  }
+  ifs.setNormalPerVertex(true);
+}
+
+long fileSize(const char* name) {
+  FILE* fp = fopen(name,"rb");
+  if(fp==(FILE*)0) return 0;
+  fseek(fp,0,SEEK_END);
+  long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+int main(int argc, char** argv) {
+  unsigned maxThreads = (argc>1)?(unsigned)atoi(argv[1]):0;
+  size_t   nFaces     = (argc>2)?(size_t)atol(argv[2]):(1<<22);
+  if(maxThreads==0) maxThreads = Parallel::getNumberOfThreads();
+  size_t nCols = 1025;
+  size_t nRows = nFaces/(2*(nCols-1))+2;
+
+  SceneGraph      wrl;
+  Shape*          shape = new Shape();
+  IndexedFaceSet* ifs   = new IndexedFaceSet();
+  shape->setGeometry(ifs);
+  wrl.addChild(shape);
+  makeGrid(*ifs,nRows,nCols);
+  cerr << "faces    = " << ifs->getNumberOfFaces() << endl;
+  cerr << "vertices = " << nRows*nCols << endl;
+
+  SaverWrl saver;
+  double base = 0.0;
+  cerr << "threads\tsave (s)\tMB/s" << endl;
+  for(unsigned nThreads=1;nThreads<=maxThreads;nThreads*=2) {
+    Parallel::setNumberOfThreads(nThreads);
+    Timer timer;
+    bool success = saver.save(fileName,wrl);
+    double t = timer.seconds();
+    double mb = (double)fileSize(fileName)/(1024.0*1024.0);
+    if(nThreads==1) base = t;
+    cerr << "  " << nThreads << "\t" << t
+         << " (x" << ((t>0.0)?base/t:0.0) << ")\t"
+         << ((t>0.0)?mb/t:0.0) << ((success)?"":" FAILED") << endl;
+  }
+  remove(fileName);
+  return 0;
+}
@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// Parallel.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <stdlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Parallel.hpp"
+
+static unsigned _nThreads = 0;
+
+// Work-stealing pool: one queue per worker, each protected by its own
+// mutex; tasks queued by threads which are not workers are spread
+// over the queues. The number of queued tasks lets idle workers sleep
+// until new tasks arrive.
+
+struct _Task {
+  function<void()>*  task;   // owned
+  atomic<size_t>*    pending;
+};
+
+struct _Queue {
+  mutex              lock;
+  deque<_Task>       tasks;
+};
+
+class _Pool {
+
+public:
+
+  _Pool(const unsigned nWorkers);
+  ~_Pool();
+
+  size_t size() const { return _queue.size(); }
+
+  void   push(const _Task& task);
+  // runs one queued task, if any, and returns true if it did
+  bool   runOne();
+
+private:
+
+  bool   _pop(_Task& task);
+  void   _work(const size_t id);
+
+  vector<_Queue*>    _queue;
+  vector<thread>     _worker;
+  atomic<size_t>     _nQueued;
+  atomic<size_t>     _nextQueue;
+  atomic<bool>       _stop;
+  mutex              _sleepLock;
+  condition_variable _wake;
+
+};
+
+// index of the queue of the current thread, or -1 if the thread is
+// not a worker of the pool
+static thread_local long _workerId = -1;
+
+_Pool::_Pool(const unsigned nWorkers):
+  _nQueued(0),
+  _nextQueue(0),
+  _stop(false) {
+  for(unsigned i=0;i<nWorkers;i++)
+    _queue.push_back(new _Queue());
+  for(unsigned i=0;i<nWorkers;i++)
+    _worker.push_back(thread(&_Pool::_work,this,(size_t)i));
+}
+
+_Pool::~_Pool() {
+  {
+    lock_guard<mutex> lk(_sleepLock);
+    _stop = true;
+  }
+  _wake.notify_all();
+  for(size_t i=0;i<_worker.size();i++)
+    _worker[i].join();
+  for(size_t i=0;i<_queue.size();i++)
+    delete _queue[i];
+}
+
+void _Pool::push(const _Task& task) {
+  size_t id = (_workerId>=0)?(size_t)_workerId:
+    _nextQueue.fetch_add(1)%_queue.size();
+  {
+    lock_guard<mutex> lk(_queue[id]->lock);
+    _queue[id]->tasks.push_back(task);
+  }
+  {
+    lock_guard<mutex> lk(_sleepLock);
+    _nQueued++;
+  }
+  _wake.notify_one();
+}
+
+bool _Pool::_pop(_Task& task) {
+  const size_t n = _queue.size();
+  // a worker takes the newest task of its own queue first
+  if(_workerId>=0) {
+    _Queue* q = _queue[(size_t)_workerId];
+    lock_guard<mutex> lk(q->lock);
+    if(q->tasks.empty()==false) {
+      task = q->tasks.back();
+      q->tasks.pop_back();
+      return true;
+    }
+  }
+  // otherwise it steals the oldest task of another queue
+  size_t start = (_workerId>=0)?(size_t)_workerId+1:0;
+  for(size_t k=0;k<n;k++) {
+    _Queue* q = _queue[(start+k)%n];
+    lock_guard<mutex> lk(q->lock);
+    if(q->tasks.empty()==false) {
+      task = q->tasks.front();
+      q->tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool _Pool::runOne() {
+  _Task task;
+  if(_pop(task)==false) return false;
+  _nQueued--;
+  (*task.task)();
+  delete task.task;
+  task.pending->fetch_sub(1,memory_order_release);
+  return true;
+}
+
+void _Pool::_work(const size_t id) {
+  _workerId = (long)id;
+  while(true) {
+    if(runOne()) continue;
+    unique_lock<mutex> lk(_sleepLock);
+    _wake.wait(lk,[this]() { return _stop || _nQueued>0; });
+    if(_stop) break;
+  }
+}
+
+// the pool is started on first use, and restarted by a thread which
+// is not a worker when the number of threads has changed
+static _Pool* _pool = (_Pool*)0;
+static mutex  _poolLock;
+
+static struct _PoolOwner {
+  ~_PoolOwner() { delete _pool; }
+} _poolOwner;
+
+static _Pool* _getPool() {
+  size_t nWorkers = Parallel::getNumberOfThreads()-1;
+  if(_workerId>=0) return _pool;
+  lock_guard<mutex> lk(_poolLock);
+  if(_pool==(_Pool*)0 || _pool->size()!=nWorkers) {
+    delete _pool;
+    _pool = (nWorkers>0)?new _Pool((unsigned)nWorkers):(_Pool*)0;
+  }
+  return _pool;
+}
+
+unsigned Parallel::getNumberOfThreads() {
+  if(_nThreads>0) return _nThreads;
+  static const unsigned nEnv = []() {
+    const char* value = getenv("DGP_NUM_THREADS");
+    long n = (value!=(const char*)0)?strtol(value,(char**)0,10):0;
+    return (unsigned)((n>0)?n:0);
+  }();
+  if(nEnv>0) return nEnv;
+  unsigned n = thread::hardware_concurrency();
+  return (n>0)?n:1;
+}
+
+void Parallel::setNumberOfThreads(const unsigned nThreads) {
+  _nThreads = nThreads;
+}
+
+void Parallel::forEach
+(const size_t nTasks, const function<void(size_t)>& task) {
+  size_t nThreads = getNumberOfThreads();
+  if(nThreads>nTasks) nThreads = nTasks;
+  if(nThreads<=1) {
+    for(size_t i=0;i<nTasks;i++)
+      task(i);
+    return;
+  }
+  // tasks are handed out dynamically, so that threads which finish
+  // early pick up the remaining work; the runners queued on the pool
+  // which start after all the tasks have been handed out return
+  // immediately
+  atomic<size_t> next(0);
+  auto runner = [&]() {
+    size_t i;
+    while((i=next.fetch_add(1))<nTasks)
+      task(i);
+  };
+  TaskGroup group;
+  for(size_t t=1;t<nThreads;t++)
+    group.run(runner);
+  runner();
+  group.wait();
+}
+
+size_t Parallel::getGrain
+(const size_t n, const size_t grain, const size_t nSerial) {
+  if(grain>0) return grain;
+  size_t nThreads = getNumberOfThreads();
+  if(nThreads<=1 || n<nSerial) return (n>0)?n:1;
+  size_t nBlocks = 4*nThreads;
+  size_t g = (n+nBlocks-1)/nBlocks;
+  return (g>0)?g:1;
+}
+
+void Parallel::forRange
+(const size_t n, const size_t grain,
+ const function<void(size_t,size_t)>& f) {
+  const size_t g = getGrain(n,grain);
+  forEach((n+g-1)/g,[&](size_t b) {
+    size_t i0 = b*g, i1 = (n-i0<g)?n:i0+g;
+    f(i0,i1);
+  });
+}
+
+Parallel::TaskGroup::TaskGroup():
+  _pending(0) {
+}
+
+Parallel::TaskGroup::~TaskGroup() {
+  wait();
+}
+
+void Parallel::TaskGroup::run(const function<void()>& task) {
+  _Pool* pool = _getPool();
+  if(pool==(_Pool*)0) {
+    task();
+    return;
+  }
+  _pending.fetch_add(1,memory_order_relaxed);
+  pool->push(_Task{new function<void()>(task),&_pending});
+}
+
+void Parallel::TaskGroup::wait() {
+  if(_pending.load(memory_order_acquire)==0) return;
+  _Pool* pool = _pool;
+  while(_pending.load(memory_order_acquire)>0)
+    if(pool->runOne()==false)
+      this_thread::yield();
+}
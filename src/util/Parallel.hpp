@@ -0,0 +1,143 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// Parallel.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _PARALLEL_HPP_
+#define _PARALLEL_HPP_
+
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+// Support for data parallel loops and task parallelism, on a shared
+// pool of getNumberOfThreads()-1 worker threads, which is started on
+// first use. Each worker owns a queue of tasks: it runs the tasks it
+// queued itself last in first out, and when its queue is empty it
+// steals the oldest tasks of the other queues. A thread which waits
+// for tasks to complete runs queued tasks in the meantime, so that
+// parallel loops can be nested. Tasks should not throw exceptions.
+
+class Parallel {
+
+public:
+
+  // defaults to the value of the DGP_NUM_THREADS environment
+  // variable, if set to a positive number, and otherwise to the
+  // number of hardware threads
+  static unsigned getNumberOfThreads();
+  // a value of 0 restores the default; the pool is resized on its
+  // next use, so this method should not be called while parallel
+  // work is in progress
+  static void     setNumberOfThreads(const unsigned nThreads);
+
+  // calls task(i) for 0<=i<nTasks; each task is executed exactly
+  // once, on the calling thread or on a worker, the indices are
+  // handed out dynamically, and forEach() returns when all of them
+  // have completed
+  static void     forEach(const size_t nTasks,
+                          const function<void(size_t)>& task);
+
+  // calls f(i0,i1) for the consecutive blocks [i0,i1) of grain
+  // indices, the last one possibly shorter, which cover [0,n); a
+  // grain of 0 splits the range into about 4 blocks per thread
+  static void     forRange(const size_t n, const size_t grain,
+                           const function<void(size_t,size_t)>& f);
+
+  // returns the values f(i0,i1) of the blocks of forRange() combined
+  // with combine(), in block order, starting from identity; with a
+  // fixed grain the result does not depend on the number of threads
+  template <class T, class F, class C>
+  static T        reduce(const size_t n, const size_t grain,
+                         const T& identity, F&& f, C&& combine) {
+    const size_t g  = getGrain(n,grain);
+    const size_t nB = (n+g-1)/g;
+    // the values are wrapped, since a vector<bool> would pack the
+    // values of several blocks into each word
+    struct Value { T value; };
+    vector<Value> value(nB,Value{identity});
+    forEach(nB,[&](size_t b) {
+      size_t i0 = b*g, i1 = (n-i0<g)?n:i0+g;
+      value[b].value = f(i0,i1);
+    });
+    T result = identity;
+    for(size_t b=0;b<nB;b++)
+      result = combine(result,value[b].value);
+    return result;
+  }
+
+  // the block size used by forRange() and reduce(); with a grain of
+  // 0, ranges shorter than nSerial, and all the ranges when there is
+  // a single thread, form a single block
+  static size_t   getGrain(const size_t n, const size_t grain,
+                           const size_t nSerial=0);
+
+  // sets cut[b]<=i<cut[b+1] to the blocks of forRange(), for loops
+  // which keep values per block, and returns their number, which is
+  // at least 1
+  template <class Index>
+  static size_t   split(const size_t n, const size_t grain, vector<Index>& cut) {
+    const size_t g  = getGrain(n,grain);
+    const size_t nB = (n>g)?(n+g-1)/g:1;
+    cut.resize(nB+1);
+    for(size_t b=0;b<nB;b++)
+      cut[b] = (Index)(b*g);
+    cut[nB] = (Index)n;
+    return nB;
+  }
+
+  // A set of tasks queued on the pool. The destructor waits for the
+  // tasks which have not completed yet. Without workers the tasks run
+  // immediately, on the calling thread.
+  class TaskGroup {
+
+  public:
+
+    TaskGroup();
+    ~TaskGroup();
+
+    void run(const function<void()>& task);
+    void wait();
+
+  private:
+
+    atomic<size_t> _pending;
+
+  };
+
+};
+
+#endif /* _PARALLEL_HPP_ */
@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// UnionFind.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _UNION_FIND_HPP_
+#define _UNION_FIND_HPP_
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+#include "Parallel.hpp"
+
+using namespace std;
+
+// Disjoint sets of the integers 0<=i<n, which several threads can
+// join and find at the same time, without locks. Each set is stored
+// as a tree of parent links, and each root is the smallest element
+// of its set: join() links the larger of the two roots under the
+// smaller one, with a compare and swap which fails, and is retried,
+// if another thread has linked the same root in the meantime. The
+// resulting sets, and so their roots, do not depend on the order in
+// which the threads join the elements. find() halves the paths it
+// traverses, also with compare and swap operations, which only
+// replace a parent by an ancestor, and may fail harmlessly.
+//
+// The index type is a template parameter, as in the Faces class.
+
+template <class Index>
+class UnionFind {
+
+public:
+
+  // each element starts in a set of its own
+  UnionFind(const Index n):
+    _parent((size_t)n) {
+    size_t grain = Parallel::getGrain((size_t)n,0,1u<<20);
+    Parallel::forRange((size_t)n,grain,[&](size_t i0, size_t i1) {
+      for(Index j=(Index)i0;j<(Index)i1;j++)
+        _parent[j].store(j,memory_order_relaxed);
+    });
+  }
+
+  Index size() const {
+    return (Index)_parent.size();
+  }
+
+  // returns the root of the set which contains i
+  Index find(Index i) {
+    for(;;) {
+      Index p = _parent[i].load(memory_order_relaxed);
+      if(p==i) return i;
+      Index q = _parent[p].load(memory_order_relaxed);
+      if(q==p) return p;
+      // path halving
+      _parent[i].compare_exchange_weak(p,q,memory_order_relaxed);
+      i = q;
+    }
+  }
+
+  // merges the sets which contain i and j; returns false if they
+  // were already the same set
+  bool join(Index i, Index j) {
+    for(;;) {
+      i = find(i);
+      j = find(j);
+      if(i==j) return false;
+      if(i<j) { Index k = i; i = j; j = k; }
+      // i is the larger root; it can only be linked while it is
+      // still a root
+      Index root = i;
+      if(_parent[i].compare_exchange_strong(root,j)) return true;
+    }
+  }
+
+  // returns true if i is the root, i.e. the smallest element, of
+  // its set; only meaningful when no other thread is joining
+  bool isRoot(const Index i) const {
+    return _parent[i].load(memory_order_relaxed)==i;
+  }
+
+private:
+
+  vector<atomic<Index> > _parent;
+
+};
+
+#endif /* _UNION_FIND_HPP_ */
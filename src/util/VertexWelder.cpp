@@ -0,0 +1,179 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// VertexWelder.cpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <math.h>
+#include <string.h>
+#include "VertexWelder.hpp"
+
+// the hash table is an open addressing table of vertex indices, with
+// linear probing, which is kept at most half full
+
+VertexWelder::VertexWelder
+(vector<float>& coord, const float epsilon, const size_t expected):
+  _coord(coord),
+  _epsilon((epsilon>0.0f)?epsilon:0.0f),
+  _table(),
+  _mask(0),
+  _nAdded(0) {
+  size_t size = 1024;
+  while(size<2*expected) size *= 2;
+  _table.resize(size,-1);
+  _mask = size-1;
+  for(int iV=0;iV<(int)(_coord.size()/3);iV++)
+    _insert(iV);
+}
+
+size_t VertexWelder::getNumberOfAdded() const {
+  return _nAdded;
+}
+
+size_t VertexWelder::getNumberOfVertices() const {
+  return _coord.size()/3;
+}
+
+float VertexWelder::getEpsilon() const {
+  return _epsilon;
+}
+
+size_t VertexWelder::getMemorySize() const {
+  return _table.capacity()*sizeof(int);
+}
+
+void VertexWelder::_cell(const float* v, int64_t* c) const {
+  for(int j=0;j<3;j++) {
+    double x = floor((double)v[j]/(double)_epsilon);
+    // also maps NaN to 0
+    if(!(x>-4.0e18)) x = -4.0e18;
+    if(x>4.0e18) x = 4.0e18;
+    c[j] = (int64_t)x;
+  }
+}
+
+uint64_t VertexWelder::_hash(const int64_t* c) {
+  uint64_t h =
+    (uint64_t)c[0]*0x9e3779b97f4a7c15ull ^
+    (uint64_t)c[1]*0xc2b2ae3d27d4eb4full ^
+    (uint64_t)c[2]*0x165667b19e3779f9ull;
+  return h^(h>>31);
+}
+
+uint64_t VertexWelder::_hash(const float* v) const {
+  int64_t c[3];
+  if(_epsilon>0.0f) {
+    _cell(v,c);
+  } else {
+    for(int j=0;j<3;j++) {
+      uint32_t bits;
+      float x = (v[j]==0.0f)?0.0f:v[j];
+      memcpy(&bits,&x,sizeof(bits));
+      c[j] = (int64_t)bits;
+    }
+  }
+  return _hash(c);
+}
+
+void VertexWelder::_insert(const int iV) {
+  size_t i = (size_t)_hash(&_coord[3*iV])&_mask;
+  while(_table[i]>=0) i = (i+1)&_mask;
+  _table[i] = iV;
+}
+
+void VertexWelder::_grow() {
+  vector<int>().swap(_table);
+  size_t size = 2*(_mask+1);
+  _table.resize(size,-1);
+  _mask = size-1;
+  for(int iV=0;iV<(int)(_coord.size()/3);iV++)
+    _insert(iV);
+}
+
+int VertexWelder::_findExact(const float* v) const {
+  size_t i = (size_t)_hash(v)&_mask;
+  int iV;
+  while((iV=_table[i])>=0) {
+    const float* u = &_coord[3*iV];
+    bool equal = true;
+    for(int j=0;j<3 && equal;j++)
+      equal = (u[j]==0.0f && v[j]==0.0f) || memcmp(&u[j],&v[j],sizeof(float))==0;
+    if(equal) return iV;
+    i = (i+1)&_mask;
+  }
+  return -1;
+}
+
+int VertexWelder::_findNearest(const float* v) const {
+  int64_t c[3], d[3], e[3];
+  _cell(v,c);
+  double eps2 = (double)_epsilon*(double)_epsilon;
+  double best = eps2;
+  int    iBest = -1;
+  for(d[0]=-1;d[0]<=1;d[0]++) {
+    for(d[1]=-1;d[1]<=1;d[1]++) {
+      for(d[2]=-1;d[2]<=1;d[2]++) {
+        for(int j=0;j<3;j++) e[j] = c[j]+d[j];
+        size_t i = (size_t)_hash(e)&_mask;
+        int iV;
+        while((iV=_table[i])>=0) {
+          const float* u = &_coord[3*iV];
+          double dx = (double)u[0]-(double)v[0];
+          double dy = (double)u[1]-(double)v[1];
+          double dz = (double)u[2]-(double)v[2];
+          double dd = dx*dx+dy*dy+dz*dz;
+          // ties are resolved in favor of the oldest vertex
+          if(dd<best || (dd==best && (iBest<0 || iV<iBest))) {
+            best  = dd;
+            iBest = iV;
+          }
+          i = (i+1)&_mask;
+        }
+      }
+    }
+  }
+  return iBest;
+}
+
+int VertexWelder::add(const float* v) {
+  _nAdded++;
+  int iV = (_epsilon>0.0f)?_findNearest(v):_findExact(v);
+  if(iV<0) {
+    iV = (int)(_coord.size()/3);
+    _coord.insert(_coord.end(),v,v+3);
+    if(2*(size_t)(iV+1)>_mask+1)
+      _grow();
+    else
+      _insert(iV);
+  }
+  return iV;
+}
@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------
+//  Copyright (C) Gabriel Taubin
+//  Time-stamp: <2026-10-17 21:00:00 taubin>
+//------------------------------------------------------------------------
+//
+// VertexWelder.hpp
+//
+// Software developed for the course
+// Digital Geometry Processing
+// Copyright (c) 2026, Gabriel Taubin
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Brown University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL GABRIEL TAUBIN BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _VERTEX_WELDER_HPP_
+#define _VERTEX_WELDER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+// Merges coincident vertices as they are added, appending the
+// distinct vertices to a coord array, and returning their indices.
+//
+// If epsilon==0 two vertices are merged only if their coordinates
+// are bit-identical, except that -0 and +0 are considered equal.
+//
+// If epsilon>0 a new vertex is merged with the closest previously
+// stored vertex within distance epsilon, if any. Stored vertices are
+// hashed by the cell of a grid of side epsilon that they belong to,
+// and the 27 cells adjacent to the cell of the new vertex are
+// searched, so that the result does not depend on the position of
+// the grid. Since the first vertex found in a cluster becomes its
+// representative, the result does depend on the order in which the
+// vertices are added; chains of vertices spaced less than epsilon
+// apart are not merged transitively.
+
+class VertexWelder {
+
+public:
+
+  // expected is an estimate of the number of distinct vertices
+  VertexWelder(vector<float>& coord,
+               const float epsilon=0.0f, const size_t expected=0);
+
+  // returns the index of v /*[3]*/ in the coord array
+  int    add(const float* v);
+
+  size_t getNumberOfAdded() const;
+  size_t getNumberOfVertices() const;
+  float  getEpsilon() const;
+  // bytes used by the hash table
+  size_t getMemorySize() const;
+
+private:
+
+  VertexWelder(const VertexWelder&);
+  VertexWelder& operator=(const VertexWelder&);
+
+  void     _cell(const float* v, int64_t* c /*[3]*/) const;
+  uint64_t _hash(const float* v) const;
+  static uint64_t _hash(const int64_t* c /*[3]*/);
+  void     _insert(const int iV);
+  void     _grow();
+  int      _findExact(const float* v) const;
+  int      _findNearest(const float* v) const;
+
+  vector<float>& _coord;
+  float          _epsilon;
+  vector<int>    _table;
+  size_t         _mask;
+  size_t         _nAdded;
+
+};
+
+#endif /* _VERTEX_WELDER_HPP_ */
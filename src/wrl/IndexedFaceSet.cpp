@@ -76,6 +76,7 @@ void IndexedFaceSet::clear() {
   _colorPerVertex  = true;
   _coord.clear();
   _coordIndex.clear();
+  _coordIndex64.clear();
   _normal.clear();
   _normalIndex.clear();
   _color.clear();
@@ -92,6 +93,7 @@ bool&          IndexedFaceSet::getNormalPerVertex()  { return _normalPerVertex;
 bool&          IndexedFaceSet::getColorPerVertex()   { return _colorPerVertex;     }
 vector<float>& IndexedFaceSet::getCoord()            { return _coord;              }
 vector<int>&   IndexedFaceSet::getCoordIndex()       { return _coordIndex;         }
+vector<int64_t>& IndexedFaceSet::getCoordIndex64()   { return _coordIndex64;       }
 vector<float>& IndexedFaceSet::getNormal()           { return _normal;             }
 vector<int>&   IndexedFaceSet::getNormalIndex()      { return _normalIndex;        }
 vector<float>& IndexedFaceSet::getColor()            { return _color;              }
@@ -104,11 +106,12 @@ int            IndexedFaceSet::getNumberOfColor()    { return (int)(_color.size(
 int            IndexedFaceSet::getNumberOfTexCoord() { return (int)(_texCoord.size()/2); }
 
 
-bool IndexedFaceSet::isTriangleMesh() {
+template <class Index>
+static bool _isTriangleMesh(const vector<Index>& coordIndex) {
   bool value = true;
-  int i0,i1,nFi;
-  for(i0=i1=0;i1<(int)_coordIndex.size();i1++) {
-    if(_coordIndex[i1]<0) {
+  size_t i0,i1,nFi;
+  for(i0=i1=0;i1<coordIndex.size();i1++) {
+    if(coordIndex[i1]<0) {
       nFi = i1-i0;
       if(nFi!=3) {
         value = false;
@@ -120,16 +123,33 @@ bool IndexedFaceSet::isTriangleMesh() {
   return value;
 }
 
-int IndexedFaceSet::getNumberOfFaces()   {
-  int nFaces = 0;
-  for(int i=0;i<(int)_coordIndex.size();i++)
-    if(_coordIndex[i]<0)
+template <class Index>
+static int64_t _getNumberOfFaces(const vector<Index>& coordIndex) {
+  int64_t nFaces = 0;
+  for(size_t i=0;i<coordIndex.size();i++)
+    if(coordIndex[i]<0)
       nFaces++;
   return nFaces;
 }
 
-int IndexedFaceSet::getNumberOfCorners() {
-  return (int)(_coordIndex.size())-getNumberOfFaces();
+bool IndexedFaceSet::hasCoordIndex64() {
+  return (_coordIndex64.size()>0);
+}
+
+bool IndexedFaceSet::isTriangleMesh() {
+  return (hasCoordIndex64())?
+    _isTriangleMesh(_coordIndex64):_isTriangleMesh(_coordIndex);
+}
+
+int64_t IndexedFaceSet::getNumberOfFaces()   {
+  return (hasCoordIndex64())?
+    _getNumberOfFaces(_coordIndex64):_getNumberOfFaces(_coordIndex);
+}
+
+int64_t IndexedFaceSet::getNumberOfCorners() {
+  int64_t nC = (int64_t)((hasCoordIndex64())?
+                         _coordIndex64.size():_coordIndex.size());
+  return nC-getNumberOfFaces();
 }
   
 IndexedFaceSet::Binding IndexedFaceSet::getCoordBinding() {
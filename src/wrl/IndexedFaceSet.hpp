@@ -59,6 +59,7 @@
 // }
 
 #include "Node.hpp"
+#include <stdint.h>
 #include <vector>
 
 using namespace std;
@@ -74,6 +75,7 @@ private:
 
   vector<float>  _coord;
   vector<int>    _coordIndex;
+  vector<int64_t> _coordIndex64;
 
   bool           _normalPerVertex;
   vector<float>  _normal;
@@ -99,6 +101,7 @@ public:
   bool&           getColorPerVertex();
   vector<float>&  getCoord();
   vector<int>&    getCoordIndex();
+  vector<int64_t>& getCoordIndex64();
   vector<float>&  getNormal();
   vector<int>&    getNormalIndex();
   vector<float>&  getColor();
@@ -106,9 +109,16 @@ public:
   vector<float>&  getTexCoord();
   vector<int>&    getTexCoordIndex();
 
+  // Meshes with more corners, or vertices, than fit in 32 bit
+  // indices store their faces in the coordIndex64 array instead, and
+  // leave the coordIndex array empty. Loaders only use the 64 bit
+  // array when necessary; code which only handles coordIndex sees
+  // such a mesh as having no faces. The following methods use
+  // whichever array is in use.
+  bool            hasCoordIndex64();
   bool            isTriangleMesh();
-  int             getNumberOfFaces();
-  int             getNumberOfCorners();
+  int64_t         getNumberOfFaces();
+  int64_t         getNumberOfCorners();
 
   int             getNumberOfCoord();
   int             getNumberOfNormal();
@@ -33,6 +33,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <math.h>
+#include <algorithm>
 #include <iostream>
 #include "SceneGraphProcessor.hpp"
 #include "SceneGraphTraversal.hpp"
@@ -41,12 +42,18 @@
 #include "IndexedLineSet.hpp"
 #include "Appearance.hpp"
 #include "Material.hpp"
+#include "Group.hpp"
+#include "core/Faces.hpp"
+#include "core/FaceIteration.hpp"
+#include "core/TriangleNormals.hpp"
+#include "util/Parallel.hpp"
 
 SceneGraphProcessor::SceneGraphProcessor(SceneGraph& wrl):
   _wrl(wrl) {
 }
 
 SceneGraphProcessor::~SceneGraphProcessor() {
+  normalUpdateReset();
 }
 
 void SceneGraphProcessor::normalClear() {
@@ -69,6 +76,185 @@ void SceneGraphProcessor::computeNormalPerCorner() {
   _applyToIndexedFaceSet(_computeNormalPerCorner);
 }
 
+void SceneGraphProcessor::normalUpdateVertices
+(IndexedFaceSet& ifs, const vector<int>& dirtyVertices) {
+  Faces* faces = _getNormalUpdateFaces(ifs);
+  if(faces==(Faces*)0) return;
+  // the list is cut short when it is long enough to trigger the full
+  // computation in _normalUpdate()
+  size_t nF = (size_t)faces->getNumberOfFaces();
+  vector<int> face;
+  for(int iV : dirtyVertices) {
+    int nj = faces->getVertexSize(iV);
+    for(int j=0;j<nj;j++)
+      face.push_back(faces->getVertexFace(iV,j));
+    if(4*face.size()>nF) break;
+  }
+  _normalUpdate(ifs,*faces,face);
+}
+
+void SceneGraphProcessor::normalUpdateFaces
+(IndexedFaceSet& ifs, const vector<int>& dirtyFaces) {
+  Faces* faces = _getNormalUpdateFaces(ifs);
+  if(faces==(Faces*)0) return;
+  int nF = faces->getNumberOfFaces();
+  vector<int> face;
+  for(int iF : dirtyFaces)
+    if(0<=iF && iF<nF) face.push_back(iF);
+  _normalUpdate(ifs,*faces,face);
+}
+
+void SceneGraphProcessor::normalUpdateReset() {
+  for(auto& i : _normalUpdateFaces)
+    delete i.second.second;
+  _normalUpdateFaces.clear();
+}
+
+// Returns the vertex corner table of the IndexedFaceSet, built if
+// necessary, or 0 if the normals cannot be updated incrementally, in
+// which case they are recomputed here
+Faces* SceneGraphProcessor::_getNormalUpdateFaces(IndexedFaceSet& ifs) {
+  IndexedFaceSet::Binding b = ifs.getNormalBinding();
+  if(b==IndexedFaceSet::PB_NONE) return (Faces*)0;
+  if(ifs.hasCoordIndex64()) {
+    _normalRecompute(ifs);
+    return (Faces*)0;
+  }
+  vector<float>& coord      = ifs.getCoord();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  vector<float>& normal     = ifs.getNormal();
+  int nV = (int)(coord.size()/3);
+  int nC = (int)coordIndex.size();
+  Faces* faces = (Faces*)0;
+  auto i = _normalUpdateFaces.find(&ifs);
+  if(i!=_normalUpdateFaces.end()) {
+    if(i->second.first==coordIndex.data() &&
+       i->second.second->getNumberOfCorners()==nC) {
+      faces = i->second.second;
+    } else {
+      delete i->second.second;
+      _normalUpdateFaces.erase(i);
+    }
+  }
+  if(faces==(Faces*)0) {
+    faces = new Faces(nV,nC,coordIndex.data());
+    faces->buildVertexCorners();
+    _normalUpdateFaces[&ifs] = make_pair((const int*)coordIndex.data(),faces);
+  }
+  // the face numbers of the Faces class, which skips empty faces,
+  // are those taken by normalUpdateFaces(), so they must match those
+  // of the IndexedFaceSet
+  if(faces->isPacked()==false) {
+    _normalRecompute(ifs);
+    return (Faces*)0;
+  }
+  if(b==IndexedFaceSet::PB_PER_VERTEX && normal.size()==coord.size())
+    return faces;
+  if(b==IndexedFaceSet::PB_PER_FACE &&
+     normal.size()==3*(size_t)faces->getNumberOfFaces())
+    return faces;
+  _normalRecompute(ifs);
+  return (Faces*)0;
+}
+
+// recomputes all the normals, with the same binding, or per face for
+// indexed normals per face
+void SceneGraphProcessor::_normalRecompute(IndexedFaceSet& ifs) {
+  IndexedFaceSet::Binding b = ifs.getNormalBinding();
+  if(b==IndexedFaceSet::PB_PER_CORNER && ifs.hasCoordIndex64()) return;
+  _normalClear(ifs);
+  if(b==IndexedFaceSet::PB_PER_VERTEX)
+    _computeNormalPerVertex(ifs);
+  else if(b==IndexedFaceSet::PB_PER_CORNER)
+    _computeNormalPerCorner(ifs);
+  else
+    _computeNormalPerFace(ifs);
+}
+
+// Recomputes the normals of the given faces, for normals per face,
+// or of their vertices, for normals per vertex, with the same
+// arithmetic as the full computations
+void SceneGraphProcessor::_normalUpdate
+(IndexedFaceSet& ifs, Faces& faces, vector<int>& face) {
+  vector<float>& coord      = ifs.getCoord();
+  vector<int>&   coordIndex = ifs.getCoordIndex();
+  vector<float>& normal     = ifs.getNormal();
+  // when a large part of the mesh is affected, the full computation,
+  // which streams through the arrays, is faster
+  size_t nF = (size_t)faces.getNumberOfFaces();
+  if(4*face.size()>nF) {
+    _normalRecompute(ifs);
+    return;
+  }
+  sort(face.begin(),face.end());
+  face.erase(unique(face.begin(),face.end()),face.end());
+  if(16*face.size()>nF) {
+    _normalRecompute(ifs);
+    return;
+  }
+  size_t nV = coord.size()/3;
+  if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_FACE) {
+    size_t nU = face.size();
+    Parallel::forRange(nU,Parallel::getGrain(nU,0,1<<16),[&](size_t k0, size_t k1) {
+      // the triangles are collected, and handed to the vector kernels
+      vector<int>   triangle,triangleFace;
+      vector<float> triangleNormal;
+      Vec3f n;
+      for(size_t k=k0;k<k1;k++) {
+        int iF = face[k];
+        int i0 = faces.getFaceFirstCorner(iF);
+        int i1 = i0+faces.getFaceSize(iF);
+        if(i1-i0==3) {
+          triangle.insert(triangle.end(),{coordIndex[i0],coordIndex[i0+1],
+                                          coordIndex[i0+2],-1});
+          triangleFace.push_back(iF);
+        } else {
+          _computeFaceNormal(coord,coordIndex,i0,i1,n,true);
+          normal[3*(size_t)iF  ] = (float)(n[0]);
+          normal[3*(size_t)iF+1] = (float)(n[1]);
+          normal[3*(size_t)iF+2] = (float)(n[2]);
+        }
+      }
+      size_t nT = triangleFace.size();
+      triangleNormal.resize(3*nT);
+      TriangleNormals::compute(coord.data(),nV,triangle.data(),nT,triangleNormal.data());
+      for(size_t t=0;t<nT;t++)
+        for(int j=0;j<3;j++)
+          normal[3*(size_t)triangleFace[t]+j] = triangleNormal[3*t+j];
+    });
+  } else /* PB_PER_VERTEX */ {
+    vector<int> vertex;
+    for(int iF : face) {
+      int i0 = faces.getFaceFirstCorner(iF);
+      int i1 = i0+faces.getFaceSize(iF);
+      vertex.insert(vertex.end(),&coordIndex[i0],&coordIndex[i0]+(i1-i0));
+    }
+    sort(vertex.begin(),vertex.end());
+    vertex.erase(unique(vertex.begin(),vertex.end()),vertex.end());
+    size_t nU = vertex.size();
+    Parallel::forRange(nU,Parallel::getGrain(nU,0,1<<16),[&](size_t k0, size_t k1) {
+      // each vertex gathers the normals of its faces in increasing
+      // corner order, as in the full computation
+      float nf[3];
+      for(size_t k=k0;k<k1;k++) {
+        int    iV = vertex[k];
+        float* ni = &normal[3*(size_t)iV];
+        ni[0] = ni[1] = ni[2] = 0.0f;
+        int nj = faces.getVertexSize(iV);
+        for(int j=0;j<nj;j++) {
+          _computeFaceNormal(coord,coordIndex,faces,faces.getVertexFace(iV,j),nf);
+          ni[0] += nf[0]; ni[1] += nf[1]; ni[2] += nf[2];
+        }
+        float nn = ni[0]*ni[0]+ni[1]*ni[1]+ni[2]*ni[2];
+        if(nn>0.0f) {
+          nn = (float)sqrt(nn);
+          ni[0] /= nn; ni[1] /= nn; ni[2] /= nn;
+        }
+      }
+    });
+  }
+}
+
 void SceneGraphProcessor::_applyToIndexedFaceSet(IndexedFaceSet::Operator o) {
   SceneGraphTraversal traversal(_wrl);
   traversal.start();
@@ -99,10 +285,11 @@ void SceneGraphProcessor::_normalInvert(IndexedFaceSet& ifs) {
     normal[i] = -normal[i];
 }
 
+template <class Index>
 void SceneGraphProcessor::_computeFaceNormal
-(vector<float>& coord, vector<int>& coordIndex,
- int i0, int i1, Vec3f& n, bool normalize) {
-  int niF,iV,i;
+(vector<float>& coord, vector<Index>& coordIndex,
+ Index i0, Index i1, Vec3f& n, bool normalize) {
+  Index niF,iV,i;
   Vec3f p,pi,ni,v1,v2;
   niF = i1-i0; // number of face corners
   // n << 0,0,0;
@@ -189,75 +376,162 @@ void SceneGraphProcessor::_computeFaceNormal
 
 void SceneGraphProcessor::_computeNormalPerFace(IndexedFaceSet& ifs) {
   if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_FACE) return;
+  if(ifs.hasCoordIndex64())
+    _computeNormalPerFace(ifs,ifs.getCoordIndex64());
+  else
+    _computeNormalPerFace(ifs,ifs.getCoordIndex());
+}
+
+template <class Index>
+void SceneGraphProcessor::_computeNormalPerFace
+(IndexedFaceSet& ifs, vector<Index>& coordIndex) {
   vector<float>& coord       = ifs.getCoord();
-  vector<int>&   coordIndex  = ifs.getCoordIndex();
   vector<float>& normal      = ifs.getNormal();
   vector<int>&   normalIndex = ifs.getNormalIndex();
   ifs.setNormalPerVertex(false);
   normal.clear();
   normalIndex.clear();
-  Vec3f n;
-  int /*iF,*/ i0,i1;
-  for(i0=i1=0;i1<(int)coordIndex.size();i1++) {
-    if(coordIndex[i1]<0) {
-      _computeFaceNormal(coord,coordIndex,i0,i1,n,true);
-      normal.push_back((float)(n[0]));
-      normal.push_back((float)(n[1]));
-      normal.push_back((float)(n[2]));
-      i0=i1+1; /* iF++; */
+  // the faces are visited in parallel, and each one writes only its
+  // own normal, so the result does not depend on the number of
+  // threads; all the triangles are handed to the vector kernels, in
+  // chunks, or one at a time in chunks which contain other polygons
+  FaceChunks<Index> chunks(coordIndex.data(),(Index)coordIndex.size());
+  normal.resize(3*(size_t)chunks.getNumberOfFaces());
+  size_t nV = coord.size()/3;
+  chunks.forEachChunk([&](Index iF0, Index iC0, Index iC1, bool triangles) {
+    if(triangles) {
+      TriangleNormals::compute(coord.data(),nV,coordIndex.data()+iC0,
+                               (size_t)(iC1-iC0)/4,&normal[3*(size_t)iF0]);
+      return;
     }
-  }
+    Vec3f n;
+    forEachFace(coordIndex.data()+iC0,iC1-iC0,[&](Index iF, Index i0, Index i1) {
+      if(i1-i0==3) {
+        TriangleNormals::compute(coord.data(),nV,coordIndex.data()+iC0+i0,1,
+                                 &normal[3*(size_t)(iF0+iF)]);
+        return;
+      }
+      _computeFaceNormal(coord,coordIndex,iC0+i0,iC0+i1,n,true);
+      normal[3*(size_t)(iF0+iF)  ] = (float)(n[0]);
+      normal[3*(size_t)(iF0+iF)+1] = (float)(n[1]);
+      normal[3*(size_t)(iF0+iF)+2] = (float)(n[2]);
+    });
+  });
 }
 
 void SceneGraphProcessor::_computeNormalPerVertex(IndexedFaceSet& ifs) {
   if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_VERTEX) return;
+  if(ifs.hasCoordIndex64())
+    _computeNormalPerVertex(ifs,ifs.getCoordIndex64());
+  else
+    _computeNormalPerVertex(ifs,ifs.getCoordIndex());
+}
+
+template <class Index>
+void SceneGraphProcessor::_computeNormalPerVertex
+(IndexedFaceSet& ifs, vector<Index>& coordIndex) {
   vector<float>& coord       = ifs.getCoord();
-  vector<int>&   coordIndex  = ifs.getCoordIndex();
   vector<float>& normal      = ifs.getNormal();
   vector<int>&   normalIndex = ifs.getNormalIndex();
   ifs.setNormalPerVertex(true);
   normal.clear();
   normalIndex.clear();
-  Vec3f n;
-  int /*iF,*/ nV,i,i0,i1,iV;
-  float x0,x1,x2;
-  nV = (int)(coord.size()/3);
+  Index nV = (Index)(coord.size()/3);
+  Index nC = (Index)coordIndex.size();
   // initialize accumulators
   normal.insert(normal.end(),coord.size(),0.0f);
-  // accumulate face normals
-  for(i0=i1=0;i1<(int)coordIndex.size();i1++) {
-    if(coordIndex[i1]<0) {
+  auto normalize = [&normal](Index iV) {
+    float* ni = &normal[3*(size_t)iV];
+    float  nn = ni[0]*ni[0]+ni[1]*ni[1]+ni[2]*ni[2];
+    if(nn>0.0f) {
+      nn = (float)sqrt(nn);
+      ni[0] /= nn; ni[1] /= nn; ni[2] /= nn;
+    }
+  };
+  size_t nThreads = Parallel::getNumberOfThreads();
+  if(nThreads<=1 || nC<(1<<20)) {
+    // accumulate face normals
+    Vec3f n;
+    forEachFace(coordIndex,[&](Index /*iF*/, Index i0, Index i1) {
       _computeFaceNormal(coord,coordIndex,i0,i1,n,false);
       // accumulate
-      for(i=i0;i<i1;i++) {
-        iV = coordIndex[i];
-        x0 = normal[3*iV  ];
-        x1 = normal[3*iV+1];
-        x2 = normal[3*iV+2];
-        normal[3*iV  ] = x0+((float)(n[0]));
-        normal[3*iV+1] = x1+((float)(n[1]));
-        normal[3*iV+2] = x2+((float)(n[2]));
+      for(Index i=i0;i<i1;i++) {
+        float* ni = &normal[3*(size_t)coordIndex[i]];
+        ni[0] += (float)(n[0]);
+        ni[1] += (float)(n[1]);
+        ni[2] += (float)(n[2]);
       }
-      i0=i1+1; /* iF++; */
-    }
+    });
+    for(Index iV=0;iV<nV;iV++)
+      normalize(iV);
+    return;
   }
-  for(iV=0;iV<nV;iV++) {
-    n[0] = normal[3*iV  ];
-    n[1] = normal[3*iV+1];
-    n[2] = normal[3*iV+2];
-    float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
-    if(nn>0.0f) {
-      nn = (float)sqrt(nn);
-      n[0] /= nn; n[1] /= nn; n[2] /= nn;
+  // Rather than scattering the face normals to the vertices, which
+  // would require locks or atomics, each vertex gathers the normals
+  // of its incident faces, listed in increasing corner order by the
+  // vertex corner table. This is the order in which the serial loop
+  // above accumulates them, so both loops produce the same bits.
+  FacesT<Index> faces(nV,nC,coordIndex.data());
+  faces.buildVertexCorners();
+  vector<float> faceNormal;
+  _computeFaceNormals(coord,coordIndex,faces,faceNormal);
+  Parallel::forRange((size_t)nV,0,[&](size_t i0, size_t i1) {
+    for(Index iV=(Index)i0;iV<(Index)i1;iV++) {
+      float* ni = &normal[3*(size_t)iV];
+      Index  nj = faces.getVertexSize(iV);
+      for(Index j=0;j<nj;j++) {
+        const float* nf = &faceNormal[3*(size_t)faces.getVertexFace(iV,j)];
+        ni[0] += nf[0];
+        ni[1] += nf[1];
+        ni[2] += nf[2];
+      }
+      normalize(iV);
     }
-    normal[3*iV  ] = n[0];
-    normal[3*iV+1] = n[1];
-    normal[3*iV+2] = n[2];
+  });
+}
+
+template <class Index>
+void SceneGraphProcessor::_computeFaceNormal
+(vector<float>& coord, vector<Index>& coordIndex,
+ FacesT<Index>& faces, Index iF, float* nf) {
+  Index i0 = faces.getFaceFirstCorner(iF);
+  Index i1 = i0+faces.getFaceSize(iF);
+  if(i1-i0==3) {
+    // the triangle case of the other _computeFaceNormal(), inlined
+    const float* p  = &coord[3*(size_t)coordIndex[i0  ]];
+    const float* p1 = &coord[3*(size_t)coordIndex[i0+1]];
+    const float* p2 = &coord[3*(size_t)coordIndex[i0+2]];
+    float v1[3] = { p1[0]-p[0], p1[1]-p[1], p1[2]-p[2] };
+    float v2[3] = { p2[0]-p[0], p2[1]-p[1], p2[2]-p[2] };
+    nf[0] = v1[1]*v2[2]-v1[2]*v2[1];
+    nf[1] = v1[2]*v2[0]-v1[0]*v2[2];
+    nf[2] = v1[0]*v2[1]-v1[1]*v2[0];
+  } else {
+    Vec3f n;
+    _computeFaceNormal(coord,coordIndex,i0,i1,n,false);
+    nf[0] = (float)(n[0]);
+    nf[1] = (float)(n[1]);
+    nf[2] = (float)(n[2]);
   }
 }
 
+template <class Index>
+void SceneGraphProcessor::_computeFaceNormals
+(vector<float>& coord, vector<Index>& coordIndex,
+ FacesT<Index>& faces, vector<float>& faceNormal) {
+  size_t nF = (size_t)faces.getNumberOfFaces();
+  faceNormal.resize(3*nF);
+  Parallel::forRange(nF,Parallel::getGrain(nF,0,1<<18),[&](size_t i0, size_t i1) {
+    for(Index iF=(Index)i0;iF<(Index)i1;iF++)
+      _computeFaceNormal(coord,coordIndex,faces,iF,&faceNormal[3*(size_t)iF]);
+  });
+}
+
 void SceneGraphProcessor::_computeNormalPerCorner(IndexedFaceSet& ifs) {
   if(ifs.getNormalBinding()==IndexedFaceSet::PB_PER_CORNER) return;
+  // the normalIndex array has 32 bit indices, so the normals of
+  // meshes stored in the coordIndex64 array are left unchanged
+  if(ifs.hasCoordIndex64()) return;
 
   vector<float>& coord       = ifs.getCoord();
   vector<int>&   coordIndex  = ifs.getCoordIndex();
@@ -267,71 +541,161 @@ void SceneGraphProcessor::_computeNormalPerCorner(IndexedFaceSet& ifs) {
   normal.clear();
   normalIndex.clear();
 
-  Vec3f pP,p0,pN,vP,vN,n;
-  int iF,i,i0,i1,ip,in,nFC,iN,iVp/*,iV0,iVn*/;
-  for(iF=i0=i1=0;i1<(int)coordIndex.size();i1++) {
-    if(coordIndex[i1]<0) {
-      nFC = i1-i0; // number of face corners
-      // n << 0,0,0;
-      n[0]=n[1]=n[2]=0.0f;
-      if(nFC>=3) { // polygon
-        for(i=i0;i<i1;i++) {
-          if((ip=i-1)< i0) ip=i1-1;
-          if((in=i+1)==i1) in=i0  ;
-
-          iVp = coordIndex[ip];
-          // iV0 = coordIndex[i ];
-          // iVn = coordIndex[in];
-
-          // pP << coord[3*iVp  ],coord[3*iVp+1],coord[3*iVp+2];
-          pP[0] = coord[3*iVp  ]; pP[1] = coord[3*iVp+1]; pP[2] = coord[3*iVp+2];
-          // p0 << coord[3*iVp  ],coord[3*iVp+1],coord[3*iVp+2];
-          p0[0] = coord[3*iVp  ]; p0[1] = coord[3*iVp+1]; p0[2] = coord[3*iVp+2];
-          // pN << coord[3*iVp  ],coord[3*iVp+1],coord[3*iVp+2];
-          pN[0] = coord[3*iVp  ]; pN[1] = coord[3*iVp+1]; pN[2] = coord[3*iVp+2];
-          // vP = pP-p0;
-          vP[0] = pP[0]-p0[0]; vP[1] = pP[1]-p0[1]; vP[2] = pP[2]-p0[2];
-          // vN = pN-p0;
-          vN[0] = pN[0]-p0[0]; vN[1] = pN[1]-p0[1]; vN[2] = pN[2]-p0[2];
-
-          // n = vN.cross(vP);
-          n[0] = vN[1]*vP[2]-vN[2]*vP[1];
-          n[1] = vN[2]*vP[0]-vN[0]*vP[2];
-          n[2] = vN[0]*vP[1]-vN[1]*vP[0];
-
-          // n.normalize();
-          float nn = n[0]*n[0]+n[1]*n[1]+n[2]*n[2];
-          if(nn>0.0f) {
-            nn = (float)sqrt(nn);
-            n[0] /= nn; n[1] /= nn; n[2] /= nn;
-          }
-
-          iN = (int)(normal.size()/3);
-          normal.push_back(n[0]);
-          normal.push_back(n[1]);
-          normal.push_back(n[2]);
-          normalIndex.push_back(iN);
-
+  int nV = (int)(coord.size()/3);
+  int nC = (int)coordIndex.size();
+  Faces faces(nV,nC,coordIndex.data());
+  faces.buildVertexCorners();
+  int nF = faces.getNumberOfFaces();
+  vector<float> faceNormal;
+  _computeFaceNormals(coord,coordIndex,faces,faceNormal);
+
+  // two faces are smoothed across an edge if the angle between their
+  // normals is smaller than the crease angle
+  double cosCrease = cos((double)ifs.getCreaseangle());
+  auto smooth = [&](int iF, int jF) {
+    const float* ni = &faceNormal[3*(size_t)iF];
+    const float* nj = &faceNormal[3*(size_t)jF];
+    double dij = (double)ni[0]*nj[0]+(double)ni[1]*nj[1]+(double)ni[2]*nj[2];
+    double dii = (double)ni[0]*ni[0]+(double)ni[1]*ni[1]+(double)ni[2]*ni[2];
+    double djj = (double)nj[0]*nj[0]+(double)nj[1]*nj[1]+(double)nj[2]*nj[2];
+    return dij>cosCrease*sqrt(dii*djj);
+  };
+
+  // the separators keep the -1 value; until the normals are numbered,
+  // the entries of the vertex corners hold the number of the
+  // smoothing group within the vertex, or -2 for the corners which
+  // only share the normal of their face
+  normalIndex.assign(coordIndex.size(),-1);
+  vector<int> vertexGroups(nV+1,0);
+  // the loops over the vertices and the faces are only split into
+  // blocks if there are enough corners, which is what the work is
+  // proportional to
+  const bool serial = (nC<(1<<20));
+  auto grain = [serial](int n) {
+    return (serial)?(size_t)n:Parallel::getGrain((size_t)n,0);
+  };
+  Parallel::forRange((size_t)nV,grain(nV),[&](size_t i0, size_t i1) {
+    vector<int> parent,group;
+    vector<pair<int,int> > edge;
+    auto find = [&parent](int j) {
+      while(parent[j]!=j) j = parent[j] = parent[parent[j]];
+      return j;
+    };
+    for(int iV=(int)i0;iV<(int)i1;iV++) {
+      int nj = faces.getVertexSize(iV);
+      if(nj==0) continue;
+      // the corners of the vertex are joined through the edges incident
+      // to the vertex, found by sorting the corners on the other
+      // vertex of the two face edges which contain them
+      parent.resize(nj);
+      edge.clear();
+      for(int j=0;j<nj;j++) {
+        parent[j] = j;
+        int iC  = faces.getVertexCorner(iV,j);
+        int iF  = faces.getVertexFace(iV,j);
+        int iC0 = faces.getFaceFirstCorner(iF);
+        int iCp = (iC==iC0)?iC0+faces.getFaceSize(iF)-1:iC-1;
+        int iCn = faces.getNextCorner(iC);
+        if(coordIndex[iCp]!=iV) edge.push_back(make_pair(coordIndex[iCp],j));
+        if(coordIndex[iCn]!=iV) edge.push_back(make_pair(coordIndex[iCn],j));
+      }
+      if(edge.size()<=16) {
+        for(size_t k=1;k<edge.size();k++)
+          for(size_t l=k;l>0 && edge[l]<edge[l-1];l--)
+            swap(edge[l],edge[l-1]);
+      } else {
+        sort(edge.begin(),edge.end());
+      }
+      for(size_t k=1;k<edge.size();k++) {
+        if(edge[k].first!=edge[k-1].first) continue;
+        int j0 = edge[k-1].second, j1 = edge[k].second;
+        if(smooth(faces.getVertexFace(iV,j0),faces.getVertexFace(iV,j1))) {
+          int r0 = find(j0), r1 = find(j1);
+          if(r0<r1) parent[r1] = r0; else parent[r0] = r1;
         }
-        normalIndex.push_back(-1);
-
-      } else /* if(nFC<3) */{ // face with less than 3 vertices
-        // throw exception ?
-        // n << 0,0,0;
-        n[0]=n[1]=n[2]=0.0f;
-        for(i=i0;i<i1;i++) {
-          iN = (int)(normal.size()/3);
-          normal.push_back(n[0]);
-          normal.push_back(n[1]);
-          normal.push_back(n[2]);
-          normalIndex.push_back(iN);
+      }
+      // the roots are the first corners of their groups; the groups
+      // are numbered as soon as a corner of a second face is found in
+      // them, and the groups contained in one face are marked with -2
+      group.assign(nj,-1);
+      int nGroups = 0;
+      for(int j=0;j<nj;j++) {
+        int r = find(j);
+        if(r==j) {
+          group[j] = -2;
+        } else if(group[r]==-2 &&
+                  faces.getVertexFace(iV,j)!=faces.getVertexFace(iV,r)) {
+          group[r] = nGroups++;
         }
-        normalIndex.push_back(-1);
       }
-
-      i0=i1+1; iF++;
+      for(int j=0;j<nj;j++)
+        normalIndex[faces.getVertexCorner(iV,j)] = group[find(j)];
+      vertexGroups[iV+1] = nGroups;
     }
-  }
+  });
+
+  // the normals of the faces which have corners marked with -2 are
+  // stored first, followed by the normals of the smoothing groups,
+  // in vertex order
+  vector<int> faceFirstNormal(nF+1,0);
+  Parallel::forRange((size_t)nF,grain(nF),[&](size_t i0, size_t i1) {
+    for(int iF=(int)i0;iF<(int)i1;iF++) {
+      int iC0 = faces.getFaceFirstCorner(iF);
+      int iC1 = iC0+faces.getFaceSize(iF);
+      for(int iC=iC0;iC<iC1;iC++)
+        if(normalIndex[iC]==-2) {
+          faceFirstNormal[iF+1] = 1;
+          break;
+        }
+    }
+  });
+  for(int iF=0;iF<nF;iF++)
+    faceFirstNormal[iF+1] += faceFirstNormal[iF];
+  int nFN = faceFirstNormal[nF];
+  vertexGroups[0] = nFN;
+  for(int iV=0;iV<nV;iV++)
+    vertexGroups[iV+1] += vertexGroups[iV];
+  normal.resize(3*(size_t)vertexGroups[nV]);
+
+  auto normalize = [&normal](int iN) {
+    float* ni = &normal[3*(size_t)iN];
+    float  nn = ni[0]*ni[0]+ni[1]*ni[1]+ni[2]*ni[2];
+    if(nn>0.0f) {
+      nn = (float)sqrt(nn);
+      ni[0] /= nn; ni[1] /= nn; ni[2] /= nn;
+    }
+  };
+  Parallel::forRange((size_t)nF,grain(nF),[&](size_t i0, size_t i1) {
+    for(int iF=(int)i0;iF<(int)i1;iF++) {
+      if(faceFirstNormal[iF+1]==faceFirstNormal[iF]) continue;
+      int iN = faceFirstNormal[iF];
+      for(int k=0;k<3;k++)
+        normal[3*(size_t)iN+k] = faceNormal[3*(size_t)iF+k];
+      normalize(iN);
+    }
+  });
+  // the normal of each group is the sum of the normals of the faces
+  // of its corners, accumulated in increasing corner order
+  Parallel::forRange((size_t)nV,grain(nV),[&](size_t i0, size_t i1) {
+    for(int iV=(int)i0;iV<(int)i1;iV++) {
+      int nj = faces.getVertexSize(iV);
+      for(int j=0;j<nj;j++) {
+        int  iC = faces.getVertexCorner(iV,j);
+        int  iF = faces.getVertexFace(iV,j);
+        int& iN = normalIndex[iC];
+        if(iN==-2) {
+          iN = faceFirstNormal[iF];
+        } else {
+          iN += vertexGroups[iV];
+          float*       ni = &normal[3*(size_t)iN];
+          const float* nf = &faceNormal[3*(size_t)iF];
+          ni[0] += nf[0]; ni[1] += nf[1]; ni[2] += nf[2];
+        }
+      }
+      for(int iN=vertexGroups[iV];iN<vertexGroups[iV+1];iN++)
+        normalize(iN);
+    }
+  });
 }
 
 void SceneGraphProcessor::bboxAdd
@@ -541,37 +905,39 @@ void SceneGraphProcessor::edgesAdd() {
         ils->clear();
 
         vector<float>& coordIfs      = ifs->getCoord();
-        vector<int>&   coordIndexIfs = ifs->getCoordIndex();
 
         vector<float>& coordIls      = ils->getCoord();
         vector<int>&   coordIndexIls = ils->getCoordIndex();
 
+        // each edge shared by several faces is added only once, and
+        // the line set refers to a single copy of the vertices
         coordIls.insert(coordIls.end(),
                         coordIfs.begin(),coordIfs.end());
 
-        int i,i0,i1,nV,iV,iV0,iV1,iF;
-        nV = static_cast<int>(coordIfs.size()/3);
-        for(iV=0;iV<nV;iV++) {
-          coordIls.push_back(coordIfs[3*iV  ]);
-          coordIls.push_back(coordIfs[3*iV+1]);
-          coordIls.push_back(coordIfs[3*iV+2]);
-        }
-
-        for(iF=i0=i1=0;i1<(int)coordIndexIfs.size();i1++) {
-          if(coordIndexIfs[i1]<0) {
-            iV0 = coordIndexIfs[i1-1];
-            for(i=i0;i<i1;i++) {
-              iV1 = coordIndexIfs[i];
-              coordIndexIls.push_back(iV0);
-              coordIndexIls.push_back(iV1);
-              coordIndexIls.push_back(-1);
-              iV0 = iV1;
-            }
-            iF++; i0 = i1+1;
+        // the vertex indices fit in the coordIndex array of the
+        // IndexedLineSet, even when the faces are stored in the
+        // coordIndex64 array
+        int nV = static_cast<int>(coordIfs.size()/3);
+        auto addEdges = [&coordIndexIls](auto& faces) {
+          faces.buildEdges();
+          size_t iE,nE = (size_t)faces.getNumberOfEdges();
+          coordIndexIls.resize(3*nE);
+          for(iE=0;iE<nE;iE++) {
+            coordIndexIls[3*iE  ] = (int)faces.getEdgeVertex(iE,0);
+            coordIndexIls[3*iE+1] = (int)faces.getEdgeVertex(iE,1);
+            coordIndexIls[3*iE+2] = -1;
           }
+        };
+        if(ifs->hasCoordIndex64()) {
+          vector<int64_t>& coordIndexIfs = ifs->getCoordIndex64();
+          Faces64 faces(nV,(int64_t)coordIndexIfs.size(),coordIndexIfs.data());
+          addEdges(faces);
+        } else {
+          vector<int>& coordIndexIfs = ifs->getCoordIndex();
+          Faces faces(nV,(int)coordIndexIfs.size(),coordIndexIfs.data());
+          addEdges(faces);
         }
 
-
       }
     }
   }
@@ -601,6 +967,294 @@ void SceneGraphProcessor::edgesRemove() {
   }
 }
 
+MeshAnalysis SceneGraphProcessor::analyzeMesh() {
+  MeshAnalysis analysis;
+  SceneGraphTraversal traversal(_wrl);
+  traversal.start();
+  Node* node;
+  while((node=traversal.next())!=(Node*)0) {
+    if(node->isShape()) {
+      Shape* shape = (Shape*)node;
+      if(shape->hasGeometryIndexedFaceSet()) {
+        IndexedFaceSet& ifs = *(IndexedFaceSet*)(shape->getGeometry());
+        // the coordIndex array is borrowed, rather than copied
+        if(ifs.hasCoordIndex64()) {
+          vector<int64_t>& coordIndex = ifs.getCoordIndex64();
+          Faces64 faces(ifs.getNumberOfCoord(),(int64_t)coordIndex.size(),
+                        coordIndex.data());
+          analysis += MeshAnalysis(faces);
+        } else {
+          vector<int>& coordIndex = ifs.getCoordIndex();
+          Faces faces(ifs.getNumberOfCoord(),(int)coordIndex.size(),
+                      coordIndex.data());
+          analysis += MeshAnalysis(faces);
+        }
+      }
+    }
+  }
+  return analysis;
+}
+
+bool SceneGraphProcessor::isWatertight() {
+  MeshAnalysis analysis = analyzeMesh();
+  return (analysis.getNumberOfFaces()>0 && analysis.isWatertight());
+}
+
+// the components are computed on the faces of the Faces class,
+// which skips empty faces, and copied to the faces of the
+// IndexedFaceSet, which counts them
+template <class Index>
+static int _labelComponents
+(vector<Index>& coordIndex, const Index nV, vector<int>& faceComponent) {
+  FacesT<Index> faces(nV,(Index)coordIndex.size(),coordIndex.data());
+  vector<Index> component;
+  Index nComponents = MeshAnalysis::labelComponents(faces,component);
+  faceComponent.clear();
+  forEachFace(coordIndex,[&](Index /*iF*/, Index i0, Index i1) {
+    faceComponent.push_back((i0<i1)?(int)component[faces.getCornerFace(i0)]:-1);
+  });
+  return (int)nComponents;
+}
+
+int SceneGraphProcessor::labelComponents
+(IndexedFaceSet& ifs, vector<int>& faceComponent) {
+  if(ifs.hasCoordIndex64())
+    return _labelComponents<int64_t>
+      (ifs.getCoordIndex64(),ifs.getNumberOfCoord(),faceComponent);
+  return _labelComponents<int>
+    (ifs.getCoordIndex(),ifs.getNumberOfCoord(),faceComponent);
+}
+
+// Maps the values of one array of an IndexedFaceSet to their indices
+// in the part being extracted, in the order of their first use. The
+// map is only allocated if the array is used, and is shared by all
+// the parts, so that each part takes time proportional to its size.
+
+class _Compactor {
+  const vector<float>& _from;
+  const int            _size;
+  vector<int>          _map;
+  vector<int>          _used;
+public:
+  _Compactor(const vector<float>& from, const int size):
+    _from(from),_size(size) {
+  }
+  int operator()(const int i) {
+    if(_map.size()==0) _map.resize(_from.size()/_size,-1);
+    if(i<0 || i>=(int)_map.size()) return -1;
+    if(_map[i]<0) {
+      _map[i] = (int)_used.size();
+      _used.push_back(i);
+    }
+    return _map[i];
+  }
+  // copies the values used by the part, and resets the map
+  void flush(vector<float>& to) {
+    for(int i : _used) {
+      to.insert(to.end(),_from.begin()+_size*i,_from.begin()+_size*(i+1));
+      _map[i] = -1;
+    }
+    _used.clear();
+  }
+};
+
+// Extracts parts made of faces of an IndexedFaceSet, where the
+// corners of face iF are faceFirstCorner[iF]<=iC<faceFirstCorner[iF+1]-1.
+
+class _FaceExtractor {
+  IndexedFaceSet&    _ifs;
+  const vector<int>& _faceFirstCorner;
+  _Compactor         _coord;
+  _Compactor         _normal;
+  _Compactor         _color;
+  _Compactor         _texCoord;
+public:
+  _FaceExtractor(IndexedFaceSet& ifs, const vector<int>& faceFirstCorner):
+    _ifs(ifs),
+    _faceFirstCorner(faceFirstCorner),
+    _coord(ifs.getCoord(),3),
+    _normal(ifs.getNormal(),3),
+    _color(ifs.getColor(),3),
+    _texCoord(ifs.getTexCoord(),2) {
+  }
+  IndexedFaceSet* extract(const int* face, const int nFaces);
+};
+
+// Returns a new IndexedFaceSet made of the given faces, in the given
+// order; only the values used by these faces are copied.
+
+IndexedFaceSet* _FaceExtractor::extract(const int* face, const int nFaces) {
+
+  IndexedFaceSet& ifs  = _ifs;
+  IndexedFaceSet* part = new IndexedFaceSet();
+  part->getCcw()             = ifs.getCcw();
+  part->getConvex()          = ifs.getConvex();
+  part->getSolid()           = ifs.getSolid();
+  part->getCreaseangle()     = ifs.getCreaseangle();
+  part->setNormalPerVertex(ifs.getNormalPerVertex());
+  part->setColorPerVertex(ifs.getColorPerVertex());
+
+  // calls f(iC) for the corners of the faces, and f(-1) after each one
+  auto forEachCorner = [&](auto f) {
+    for(int k=0;k<nFaces;k++) {
+      const int iF = face[k];
+      for(int iC=_faceFirstCorner[iF];iC<_faceFirstCorner[iF+1]-1;iC++)
+        f(iC);
+      f(-1);
+    }
+  };
+  auto copyCorners = [&](const vector<int>& from, vector<int>& to,
+                         _Compactor& compact) {
+    forEachCorner([&](int iC) {
+      to.push_back((iC<0)?-1:compact(from[iC]));
+    });
+  };
+  // per vertex values are used in the same order as the coordinates,
+  // so that they get the same indices
+  auto useVertices = [&](_Compactor& compact) {
+    const vector<int>& coordIndex = ifs.getCoordIndex();
+    forEachCorner([&](int iC) {
+      if(iC>=0) compact(coordIndex[iC]);
+    });
+  };
+  auto copyFaces = [&](const vector<float>& from, vector<float>& to,
+                       const int size) {
+    for(int k=0;k<nFaces;k++)
+      if((size_t)size*(face[k]+1)<=from.size())
+        to.insert(to.end(),from.begin()+size*face[k],from.begin()+size*(face[k]+1));
+  };
+  auto copyFaceIndex = [&](const vector<int>& from, vector<int>& to,
+                           _Compactor& compact) {
+    for(int k=0;k<nFaces;k++)
+      to.push_back(compact((face[k]<(int)from.size())?from[face[k]]:-1));
+  };
+
+  copyCorners(ifs.getCoordIndex(),part->getCoordIndex(),_coord);
+  _coord.flush(part->getCoord());
+
+  switch(ifs.getNormalBinding()) {
+  case IndexedFaceSet::PB_PER_VERTEX:
+    useVertices(_normal);
+    break;
+  case IndexedFaceSet::PB_PER_FACE:
+    copyFaces(ifs.getNormal(),part->getNormal(),3);
+    break;
+  case IndexedFaceSet::PB_PER_FACE_INDEXED:
+    copyFaceIndex(ifs.getNormalIndex(),part->getNormalIndex(),_normal);
+    break;
+  case IndexedFaceSet::PB_PER_CORNER:
+    copyCorners(ifs.getNormalIndex(),part->getNormalIndex(),_normal);
+    break;
+  default:
+    break;
+  }
+  _normal.flush(part->getNormal());
+
+  switch(ifs.getColorBinding()) {
+  case IndexedFaceSet::PB_PER_VERTEX:
+    useVertices(_color);
+    break;
+  case IndexedFaceSet::PB_PER_FACE:
+    copyFaces(ifs.getColor(),part->getColor(),3);
+    break;
+  case IndexedFaceSet::PB_PER_FACE_INDEXED:
+    copyFaceIndex(ifs.getColorIndex(),part->getColorIndex(),_color);
+    break;
+  case IndexedFaceSet::PB_PER_CORNER:
+    copyCorners(ifs.getColorIndex(),part->getColorIndex(),_color);
+    break;
+  default:
+    break;
+  }
+  _color.flush(part->getColor());
+
+  switch(ifs.getTexCoordBinding()) {
+  case IndexedFaceSet::PB_PER_VERTEX:
+    useVertices(_texCoord);
+    break;
+  case IndexedFaceSet::PB_PER_CORNER:
+    copyCorners(ifs.getTexCoordIndex(),part->getTexCoordIndex(),_texCoord);
+    break;
+  default:
+    break;
+  }
+  _texCoord.flush(part->getTexCoord());
+
+  return part;
+}
+
+int SceneGraphProcessor::componentsSplit() {
+
+  // the Shape nodes are collected first, since the traversal must
+  // not see the scene graph change
+  vector<Shape*> shapes;
+  SceneGraphTraversal traversal(_wrl);
+  traversal.start();
+  Node* node;
+  while((node=traversal.next())!=(Node*)0)
+    if(node->isShape() && ((Shape*)node)->hasGeometryIndexedFaceSet() &&
+       node->getParent()!=(Node*)0 && node->getParent()->isGroup())
+      shapes.push_back((Shape*)node);
+
+  int nSplit = 0;
+  for(Shape* shape : shapes) {
+    IndexedFaceSet& ifs = *(IndexedFaceSet*)(shape->getGeometry());
+    // the parts are extracted with 32 bit indices, so meshes stored
+    // in the coordIndex64 array are not split
+    if(ifs.hasCoordIndex64()) continue;
+    vector<int> faceComponent;
+    int nComponents = labelComponents(ifs,faceComponent);
+    if(nComponents<=1) continue;
+
+    // group the faces by component, in increasing order within each
+    // component, with a counting sort
+    int nF = (int)faceComponent.size();
+    vector<int> first(nComponents+1,0);
+    for(int iF=0;iF<nF;iF++)
+      if(faceComponent[iF]>=0) first[faceComponent[iF]+1]++;
+    for(int k=0;k<nComponents;k++)
+      first[k+1] += first[k];
+    vector<int> face(first[nComponents]);
+    vector<int> position(first.begin(),first.end()-1);
+    for(int iF=0;iF<nF;iF++)
+      if(faceComponent[iF]>=0) face[position[faceComponent[iF]]++] = iF;
+
+    vector<int> faceFirstCorner;
+    forEachFace(ifs.getCoordIndex(),[&](int /*iF*/, int i0, int i1) {
+      faceFirstCorner.push_back(i0);
+      if(faceFirstCorner.size()==(size_t)nF) faceFirstCorner.push_back(i1+1);
+    });
+
+    _FaceExtractor extractor(ifs,faceFirstCorner);
+    Group* parts = new Group();
+    parts->setName(shape->getName());
+    parts->setShow(shape->getShow());
+    for(int k=0;k<nComponents;k++) {
+      Shape* part = new Shape();
+      part->setShow(shape->getShow());
+      if(shape->getAppearance()!=(Node*)0)
+        part->setAppearance(shape->getAppearance());
+      part->setGeometry(extractor.extract(face.data()+first[k],
+                                          first[k+1]-first[k]));
+      parts->addChild(part);
+    }
+
+    // the Group takes the place of the Shape in its parent; the Shape
+    // does not own its Appearance, which is now shared by the parts
+    Group* parent = (Group*)(shape->getParent());
+    vector<pNode>& children = parent->getChildren();
+    for(size_t i=0;i<children.size();i++)
+      if(children[i]==shape) {
+        children[i] = parts;
+        parts->setParent(parent);
+      }
+    delete &ifs;
+    delete shape;
+    nSplit++;
+  }
+  return nSplit;
+}
+
 void SceneGraphProcessor::shapeIndexedFaceSetShow() {
   SceneGraphTraversal traversal(_wrl);
   traversal.start();
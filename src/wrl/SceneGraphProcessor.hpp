@@ -36,10 +36,12 @@
 #define _SceneGraphProcessor_hpp_
 
 #include <iostream>
+#include <map>
 #include "SceneGraph.hpp"
 #include "Shape.hpp"
 #include "IndexedFaceSet.hpp"
 #include "IndexedLineSet.hpp"
+#include "core/MeshAnalysis.hpp"
 
 class SceneGraphProcessor {
 
@@ -52,8 +54,32 @@ public:
   void normalInvert();
   void computeNormalPerFace();
   void computeNormalPerVertex();
+  // the corners incident to each vertex are split into smoothing
+  // groups, joined across the edges where the angle between the face
+  // normals is smaller than the creaseAngle field of the
+  // IndexedFaceSet; all the corners of a group share one normal, and
+  // the corners which do not share the normal of their face with the
+  // corners of any other face share the face normal; the normals of
+  // meshes with 64 bit indices are left unchanged
   void computeNormalPerCorner();
 
+  // Incremental updates of the normals of an IndexedFaceSet, after
+  // the coordinates of some vertices have been modified. The first
+  // method takes the modified vertices, and the second one the faces
+  // whose normals have changed. The normals of the affected faces
+  // are recomputed, and, for normals per vertex, the normals of the
+  // vertices of those faces, with the same values as a full
+  // computation. Large updates run in parallel. Normals per corner,
+  // and meshes with empty faces or 64 bit indices, are recomputed
+  // completely. The vertex corner table of each IndexedFaceSet is
+  // built on the first update and kept by the processor, so that
+  // later updates take time proportional to the number of affected
+  // faces; normalUpdateReset() must be called after the coordIndex
+  // array of an IndexedFaceSet is modified.
+  void normalUpdateVertices(IndexedFaceSet& ifs, const vector<int>& dirtyVertices);
+  void normalUpdateFaces(IndexedFaceSet& ifs, const vector<int>& dirtyFaces);
+  void normalUpdateReset();
+
   void bboxAdd(int depth=0, float scale=1.0f, bool isCube=true);
   void bboxRemove();
   bool hasBBox();
@@ -62,6 +88,25 @@ public:
   void edgesRemove();
   bool hasEdges();
 
+  // analyzes the topology of each IndexedFaceSet, and adds up the
+  // results; see core/MeshAnalysis.hpp
+  MeshAnalysis analyzeMesh();
+  bool isWatertight();
+
+  // The first method sets faceComponent[iF] to the connected
+  // component of each face iF of the IndexedFaceSet, or to -1 for
+  // empty faces, and returns the number of components; see
+  // MeshAnalysis::labelComponents(). The second one replaces each
+  // Shape whose IndexedFaceSet has more than one component by a
+  // Group, with the same name, which contains one Shape per
+  // component, and returns the number of Shape nodes replaced. The
+  // new Shape nodes share the Appearance node of the original one,
+  // and their IndexedFaceSet nodes only contain the coord, normal,
+  // color and texCoord values used by their faces. Meshes with 64
+  // bit indices are not split.
+  static int labelComponents(IndexedFaceSet& ifs, vector<int>& faceComponent);
+  int  componentsSplit();
+
   bool hasIndexedFaceSetFaces();
   bool hasIndexedFaceSetNormalNone();
   bool hasIndexedFaceSetNormalPerFace();
@@ -91,6 +136,14 @@ private:
 
   SceneGraph&    _wrl;
 
+  // vertex corner tables kept for the incremental normal updates,
+  // along with the coordIndex storage they borrow
+  map<IndexedFaceSet*,pair<const int*,Faces*> > _normalUpdateFaces;
+
+  Faces*      _getNormalUpdateFaces(IndexedFaceSet& ifs);
+  void        _normalUpdate(IndexedFaceSet& ifs, Faces& faces, vector<int>& face);
+  static void _normalRecompute(IndexedFaceSet& ifs);
+
   void        _applyToIndexedFaceSet(IndexedFaceSet::Operator p);
 
   // IndexedFaceSet::Operator
@@ -100,9 +153,30 @@ private:
   static void _computeNormalPerVertex(IndexedFaceSet& ifs);
   static void _computeNormalPerCorner(IndexedFaceSet& ifs);
 
+  // the normals per face and per vertex are computed on the
+  // coordIndex array, or on the coordIndex64 array for meshes too
+  // large for 32 bit indices
+  template <class Index>
+  static void _computeNormalPerFace
+              (IndexedFaceSet& ifs, vector<Index>& coordIndex);
+  template <class Index>
+  static void _computeNormalPerVertex
+              (IndexedFaceSet& ifs, vector<Index>& coordIndex);
+
+  template <class Index>
+  static void _computeFaceNormal
+              (vector<float>& coord, vector<Index>& coordIndex,
+               Index i0, Index i1, Vec3f& n, bool normalize);
+  // the non normalized normal of one face, and of all the faces, in
+  // parallel
+  template <class Index>
   static void _computeFaceNormal
-              (vector<float>& coord, vector<int>&   coordIndex,
-               int i0, int i1, Vec3f& n, bool normalize);
+              (vector<float>& coord, vector<Index>& coordIndex,
+               FacesT<Index>& faces, Index iF, float* nf);
+  template <class Index>
+  static void _computeFaceNormals
+              (vector<float>& coord, vector<Index>& coordIndex,
+               FacesT<Index>& faces, vector<float>& faceNormal);
 
   bool        _hasShapeProperty(Shape::Property p);
   bool        _hasIndexedFaceSetProperty(IndexedFaceSet::Property p);